@@ -0,0 +1,102 @@
+#-------------------------------------------------
+#
+# Core of the gesture control system: camera capture, hand detection,
+# gesture recognition and command input.
+#
+# It only needs Qt Core and Qt Gui (for QImage) and is shared by the GUI
+# application (GestureRecognition.pro) and the headless daemon
+# (gesture-daemon.pro).
+#
+#-------------------------------------------------
+
+CONFIG += c++11
+
+INCLUDEPATH += $$PWD/src
+
+SOURCES += $$PWD/src/MySettings.cpp \
+    $$PWD/src/BackgroundModel.cpp \
+    $$PWD/src/SkinColorTable.cpp \
+    $$PWD/src/BinaryMask.cpp \
+    $$PWD/src/ConnectedComponents.cpp \
+    $$PWD/src/FingerTracker.cpp \
+    $$PWD/src/HandObservation.cpp \
+    $$PWD/src/HandDetector.cpp \
+    $$PWD/src/GestureAnalyst.cpp \
+    $$PWD/src/CommandInputter.cpp \
+    $$PWD/src/SampleCollector.cpp \
+    $$PWD/src/ImgConvertor.cpp \
+    $$PWD/src/CaptureGeometry.cpp \
+    $$PWD/src/LatencyHistogram.cpp \
+    $$PWD/src/StageProfiler.cpp \
+    $$PWD/src/CameraSource.cpp \
+    $$PWD/src/ReplaySource.cpp \
+    $$PWD/src/SharedMemoryRing.cpp \
+    $$PWD/src/SharedMemorySource.cpp \
+    $$PWD/src/FrameSourceFactory.cpp \
+    $$PWD/src/FramePipeline.cpp \
+    $$PWD/src/InferenceService.cpp \
+    $$PWD/src/GestureEngine.cpp
+
+HEADERS += $$PWD/src/global.h \
+    $$PWD/src/Singleton.h \
+    $$PWD/src/Settings.h \
+    $$PWD/src/BackgroundModel.h \
+    $$PWD/src/SkinColorTable.h \
+    $$PWD/src/BinaryMask.h \
+    $$PWD/src/ConnectedComponents.h \
+    $$PWD/src/FingerTracker.h \
+    $$PWD/src/HandObservation.h \
+    $$PWD/src/HandDetector.h \
+    $$PWD/src/SampleCollector.h \
+    $$PWD/src/ImgConvertor.h \
+    $$PWD/src/CommandInputterInterface.h \
+    $$PWD/src/CommandInputter.h \
+    $$PWD/src/GestureAnalystInterface.h \
+    $$PWD/src/GestureAnalyst.h \
+    $$PWD/src/SpscQueue.h \
+    $$PWD/src/ParallelInvoker.h \
+    $$PWD/src/FrameMailbox.h \
+    $$PWD/src/CaptureGeometry.h \
+    $$PWD/src/LatencyHistogram.h \
+    $$PWD/src/StageProfiler.h \
+    $$PWD/src/FrameSourceInterface.h \
+    $$PWD/src/CameraSource.h \
+    $$PWD/src/ReplaySource.h \
+    $$PWD/src/SharedMemoryRing.h \
+    $$PWD/src/SharedMemorySource.h \
+    $$PWD/src/FrameSourceFactory.h \
+    $$PWD/src/FramePipeline.h \
+    $$PWD/src/InferenceService.h \
+    $$PWD/src/GestureEngine.h
+
+# shm_open of the shared memory frame source
+unix:!macx: LIBS += -lrt
+
+# the network structure loaded by GestureAnalyst
+RESOURCES += $$PWD/data/qrc.qrc
+
+
+INCLUDEPATH += /usr/local/cellar/lmdb/0.9.19/include
+LIBS += -L/usr/local/cellar/lmdb/0.9.19/lib -llmdb
+
+INCLUDEPATH += /usr/local/cellar/boost/1.63.0/include
+LIBS += -L/usr/local/cellar/boost/1.63.0/lib -lboost_system
+
+INCLUDEPATH += /usr/local/include                   # opencv, gflags or maybe others
+LIBS += -L/usr/local/lib -lopencv_videoio -lopencv_video -lopencv_imgproc -lopencv_core -lopencv_imgcodecs
+
+INCLUDEPATH += /usr/local/cuda/include
+INCLUDEPATH += /usr/local/cellar/openblas/0.2.18_2/include
+
+INCLUDEPATH += /usr/local/cellar/glog/0.3.4_1/include
+LIBS += -L/usr/local/cellar/glog/0.3.4_1/lib -lglog
+
+INCLUDEPATH += /usr/local/cellar/protobuf/3.2.0/include
+LIBS += -L/usr/local/cellar/protobuf/3.2.0/lib -lprotobuf
+
+INCLUDEPATH += /Users/XP/Downloads/caffe-master/include
+QMAKE_RPATHDIR += /Users/XP/Downloads/caffe-master/build/lib
+LIBS += -L/Users/XP/Downloads/caffe-master/build/lib -lcaffe
+
+
+LIBS += -framework ApplicationServices
@@ -0,0 +1,32 @@
+#-------------------------------------------------
+#
+# Micro-benchmark of the hot functions: hand detection, sample resizing,
+# gesture recognition, image conversion and action counting.
+# It reports ns/op and allocations/op using the images in samples/.
+#
+#-------------------------------------------------
+
+QT       = core gui
+
+TARGET = bench
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+DEFINES += BENCH_SAMPLES_DIR=\\\"$$PWD/samples\\\"
+
+include(GestureCore.pri)
+
+INCLUDEPATH += src/bench
+
+SOURCES += src/bench/main.cpp \
+    src/bench/Benchmark.cpp
+
+HEADERS += src/bench/Benchmark.h
+
+# make check fails if passing the detected hand on to other threads allocates anything in steady state
+check.commands = ./$(TARGET) --check-allocations
+check.depends = $(TARGET)
+QMAKE_EXTRA_TARGETS += check
@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# Headless daemon who drives keyboard and mouse events by gestures
+# without any window. It reads the same setting file as GestureRecognition.
+#
+#-------------------------------------------------
+
+QT       = core gui
+
+TARGET = gesture-daemon
+TEMPLATE = app
+
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(GestureCore.pri)
+
+INCLUDEPATH += src/daemon
+
+SOURCES += src/daemon/main.cpp \
+    src/daemon/ReplayEngine.cpp
+
+HEADERS += src/daemon/ReplayEngine.h
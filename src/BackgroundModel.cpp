@@ -0,0 +1,77 @@
+#include "BackgroundModel.h"
+
+BackgroundModel::BackgroundModel() :
+    _shrunk(false),
+    _learning_rate(DEFAULT_BACKGROUND_LEARNING_RATE)
+{}
+
+void BackgroundModel::setReference(const cv::Mat &bgr)
+{
+    CV_Assert(bgr.type() == CV_8UC3);
+    bgr.copyTo(_reference);
+    _average.release();
+    _shrunk = false;
+}
+
+void BackgroundModel::clear()
+{
+    _reference.release();
+    _shrunk_reference.release();
+    _average.release();
+    _shrunk = false;
+}
+
+bool BackgroundModel::empty() const
+{
+    return _reference.empty();
+}
+
+const cv::Mat &BackgroundModel::reference() const
+{
+    return _reference;
+}
+
+const cv::Mat &BackgroundModel::reference(const cv::Size &size)
+{
+    if (size == _reference.size())
+        return _reference;
+    if (!_shrunk || _shrunk_reference.size() != size)
+    {
+        cv::resize(_reference, _shrunk_reference, size, 0, 0, cv::INTER_NEAREST);
+        _shrunk = true;
+    }
+    return _shrunk_reference;
+}
+
+void BackgroundModel::setLearningRate(const double &rate)
+{
+    _learning_rate = rate > 0 ? std::min(rate, 1.0) : 0;
+    _average.release();
+}
+
+double BackgroundModel::learningRate() const
+{
+    return _learning_rate;
+}
+
+void BackgroundModel::update(const cv::Mat &bgr)
+{
+    if (_learning_rate == 0 || _reference.empty() || bgr.size() != _reference.size())
+        return;
+    if (_average.empty())
+        _reference.convertTo(_average, CV_32FC3);
+    // the hand must not fade into the background
+    apply(bgr, _background_mask);
+    cv::bitwise_not(_background_mask, _background_mask);
+    cv::accumulateWeighted(bgr, _average, _learning_rate, _background_mask);
+    _average.convertTo(_reference, CV_8UC3);
+    _shrunk = false;
+}
+
+void BackgroundModel::apply(const cv::Mat &bgr, cv::Mat &foreground) const
+{
+    CV_Assert(bgr.type() == CV_8UC3 && bgr.size() == _reference.size());
+    foreground.create(bgr.size(), CV_8UC1);
+    for (int y = 0; y < bgr.rows; ++y)
+        BackgroundModel::foreground(bgr.ptr<uchar>(y), _reference.ptr<uchar>(y), foreground.ptr<uchar>(y), bgr.cols);
+}
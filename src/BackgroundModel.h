@@ -0,0 +1,101 @@
+#ifndef BACKGROUNDMODEL_H
+#define BACKGROUNDMODEL_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The BackgroundModel.h file contains the background model who tells the foreground pixels by their color distance from a stored background image.
+ */
+#include <opencv2/opencv.hpp>
+
+#include "global.h"
+
+/**
+ * @brief The BackgroundModel class stores a background image and tells if a pixel differs from it.
+ *
+ * A pixel is foreground if the squared distance between its BGR color and the one of the background is at least #BACKGROUND_SQUARED_DISTANCE .
+ * This is the decision of `cv::BackgroundSubtractorMOG2`, with a history of 1 and a variance threshold of 16, who learned the background image alone
+ * and is then applied with a learning rate of 0, as the hand detector used it before.
+ *
+ * The test is cheap enough to be done on the fly by the skin color filter, see #SkinColorTable::classify , such that no foreground mask is stored.
+ *
+ * If a learning rate is set, #BackgroundModel::update blends the background pixels of each frame into the background image,
+ * so that slow changes of the lighting are followed.
+ */
+class BackgroundModel
+{
+public:
+    BackgroundModel();
+
+    /**
+     * @brief setReference stores a copy of the `CV_8UC3` image as the background image.
+     */
+    void setReference(const cv::Mat &bgr);
+    /**
+     * @brief clear forgets the background image.
+     */
+    void clear();
+    /**
+     * @brief empty returns if no background image is stored.
+     */
+    bool empty() const;
+    /**
+     * @brief reference returns the background image.
+     */
+    const cv::Mat &reference() const;
+    /**
+     * @brief reference returns the background image shrunk to the given size by nearest neighbours.
+     *
+     * The shrunk image is kept until the size or the background image change.
+     */
+    const cv::Mat &reference(const cv::Size &size);
+    /**
+     * @brief setLearningRate sets the weight by which a background pixel of a frame is blended into the background image, 0 to keep the background image.
+     */
+    void setLearningRate(const double &rate);
+    /**
+     * @brief learningRate returns the weight by which a background pixel of a frame is blended into the background image.
+     */
+    double learningRate() const;
+    /**
+     * @brief update blends the background pixels of the frame into the background image. It does nothing if the learning rate is 0.
+     */
+    void update(const cv::Mat &bgr);
+    /**
+     * @brief apply computes the `CV_8UC1` foreground mask of the frame, 255 for the pixels differing from the background.
+     */
+    void apply(const cv::Mat &bgr, cv::Mat &foreground) const;
+
+    /**
+     * @brief foreground tests a row of pixels against the same row of the background image.
+     *
+     * It is written as a plain loop over the pixels without branches such that the compiler vectorizes it.
+     *
+     * @param bgr : `cols` BGR pixels
+     * @param reference : `cols` BGR pixels of the background image
+     * @param out : the place where 255 for each foreground pixel and 0 for each background one will be stored
+     * @param cols : number of pixels
+     */
+    inline static void foreground(const uchar *bgr, const uchar *reference, uchar *out, const int &cols);
+
+private:
+    cv::Mat _reference;
+    cv::Mat _shrunk_reference;
+    bool _shrunk;
+    double _learning_rate;
+    // the running average who is rounded into the background image
+    cv::Mat _average;
+    cv::Mat _background_mask;
+};
+
+void BackgroundModel::foreground(const uchar *bgr, const uchar *reference, uchar *out, const int &cols)
+{
+    for (int x = 0; x < cols; ++x)
+    {
+        const int db = bgr[3*x] - reference[3*x];
+        const int dg = bgr[3*x+1] - reference[3*x+1];
+        const int dr = bgr[3*x+2] - reference[3*x+2];
+        out[x] = db*db + dg*dg + dr*dr >= BACKGROUND_SQUARED_DISTANCE ? 255 : 0;
+    }
+}
+
+#endif // BACKGROUNDMODEL_H
@@ -0,0 +1,307 @@
+#include "BinaryMask.h"
+
+namespace
+{
+
+// the pixel at column p + s of an extended row, whose word 0 is the guard before the first word of the row
+inline quint64 shiftedWord(const quint64 *ext, const int &i, const int &s)
+{
+    if (s > 0)
+        return (ext[i+1] >> s) | (ext[i+2] << (64-s));
+    if (s < 0)
+        return (ext[i+1] << -s) | (ext[i] >> (64+s));
+    return ext[i+1];
+}
+
+}
+
+BinaryMask::BinaryMask() :
+    _rows(0),
+    _cols(0),
+    _words_per_row(0),
+    _blur_sigma(0),
+    _blur_thresh(0),
+    _min_sum(0),
+    _core_radius(-1)
+{}
+
+void BinaryMask::create(const cv::Size &size)
+{
+    _rows = size.height;
+    _cols = size.width;
+    _words_per_row = (_cols + 63)/64;
+    _words.resize(static_cast<std::size_t>(_rows)*_words_per_row);
+}
+
+cv::Size BinaryMask::size() const
+{
+    return cv::Size(_cols, _rows);
+}
+
+bool BinaryMask::empty() const
+{
+    return _rows == 0 || _cols == 0;
+}
+
+int BinaryMask::wordsPerRow() const
+{
+    return _words_per_row;
+}
+
+int BinaryMask::count() const
+{
+    int n = 0;
+    for (const auto &w : _words)
+        n += __builtin_popcountll(w);
+    return n;
+}
+
+void BinaryMask::pack(const cv::Mat &mask)
+{
+    CV_Assert(mask.type() == CV_8UC1);
+    create(mask.size());
+    for (int y = 0; y < _rows; ++y)
+    {
+        const uchar *src = mask.ptr<uchar>(y);
+        quint64 *dst = row(y);
+        for (int i = 0; i < _words_per_row; ++i)
+        {
+            const int n = std::min(64, _cols - i*64);
+            quint64 word = 0;
+            for (int b = 0; b < n; ++b)
+                word |= quint64(src[b] != 0) << b;
+            dst[i] = word;
+            src += n;
+        }
+    }
+}
+
+void BinaryMask::unpack(cv::Mat &mask) const
+{
+    mask.create(_rows, _cols, CV_8UC1);
+    unpack(mask, 0);
+}
+
+void BinaryMask::unpack(cv::Mat &mask, const int &first_row) const
+{
+    CV_Assert(mask.type() == CV_8UC1 && mask.cols == _cols && first_row >= 0 && first_row + mask.rows <= _rows);
+    for (int y = 0; y < mask.rows; ++y)
+    {
+        const quint64 *src = row(first_row + y);
+        uchar *dst = mask.ptr<uchar>(y);
+        for (int i = 0; i < _words_per_row; ++i)
+        {
+            const int n = std::min(64, _cols - i*64);
+            const quint64 word = src[i];
+            for (int b = 0; b < n; ++b)
+                dst[b] = static_cast<uchar>(-static_cast<int>((word >> b) & 1));
+            dst += n;
+        }
+    }
+}
+
+void BinaryMask::erode(const BinaryMask &src, const cv::Mat &kernel)
+{
+    CV_Assert(&src != this);
+    create(src.size());
+    _setSegments(kernel);
+    _morph(src, true, _words.data());
+}
+
+void BinaryMask::dilate(const BinaryMask &src, const cv::Mat &kernel)
+{
+    CV_Assert(&src != this);
+    create(src.size());
+    _setSegments(kernel);
+    _morph(src, false, _words.data());
+}
+
+void BinaryMask::blurThreshold(const BinaryMask &src, const cv::Size &ksize, const double &sigma, const int &thresh)
+{
+    CV_Assert(&src != this);
+    create(src.size());
+    _setBlurWeights(ksize, sigma, thresh);
+    const int rx = static_cast<int>(_weights_x.size()/2);
+    const int ry = static_cast<int>(_weights_y.size()/2);
+
+    // pixels having a set pixel within the core pass the threshold whatever the others are
+    if (_core_radius >= 0)
+    {
+        _setRectSegments(_core_radius, _core_radius);
+        _morph(src, false, _words.data());
+    }
+    else
+        std::fill(_words.begin(), _words.end(), 0);
+    // the others pass only if they have set pixels within the kernel and their weights are large enough
+    _neighbourhood.resize(_words.size());
+    _setRectSegments(rx, ry);
+    _morph(src, false, _neighbourhood.data());
+
+    for (int y = 0; y < _rows; ++y)
+    {
+        quint64 *dst = row(y);
+        const quint64 *near = _neighbourhood.data() + static_cast<std::size_t>(y)*_words_per_row;
+        for (int i = 0; i < _words_per_row; ++i)
+        {
+            quint64 candidates = near[i] & ~dst[i];
+            while (candidates)
+            {
+                const int b = __builtin_ctzll(candidates);
+                candidates &= candidates - 1;
+                if (_blurredSum(src, i*64 + b, y) >= _min_sum)
+                    dst[i] |= quint64(1) << b;
+            }
+        }
+    }
+}
+
+void BinaryMask::_setSegments(const cv::Mat &kernel)
+{
+    CV_Assert(kernel.type() == CV_8UC1 && kernel.cols < 128);
+    const int ax = kernel.cols/2;
+    const int ay = kernel.rows/2;
+    _segments.clear();
+    _ranges.clear();
+    for (int ky = 0; ky < kernel.rows; ++ky)
+    {
+        const uchar *k = kernel.ptr<uchar>(ky);
+        int kx = 0;
+        while (kx < kernel.cols)
+        {
+            if (k[kx] == 0)
+            {
+                ++kx;
+                continue;
+            }
+            // a run of the kernel row becomes one horizontal range
+            const int lo = kx - ax;
+            while (kx < kernel.cols && k[kx] != 0)
+                ++kx;
+            const auto range = std::make_pair(lo, kx - 1 - ax);
+            auto it = std::find(_ranges.begin(), _ranges.end(), range);
+            if (it == _ranges.end())
+                it = _ranges.insert(_ranges.end(), range);
+            _segments.push_back(Segment{ky - ay, static_cast<int>(it - _ranges.begin())});
+        }
+    }
+}
+
+void BinaryMask::_setRectSegments(const int &rx, const int &ry)
+{
+    _segments.clear();
+    _ranges.assign(1, std::make_pair(-rx, rx));
+    for (int dy = -ry; dy <= ry; ++dy)
+        _segments.push_back(Segment{dy, 0});
+}
+
+void BinaryMask::_morph(const BinaryMask &src, const bool &erode, quint64 *out)
+{
+    const int n = _words_per_row;
+    const quint64 fill = erode ? ~quint64(0) : 0;
+    const quint64 tail = _tailMask();
+    const std::size_t plane = static_cast<std::size_t>(_rows)*n;
+
+    // OR or AND each row over the horizontal ranges of the kernel
+    _horizontal.resize(_ranges.size()*plane);
+    _extended_row.resize(n + 2);
+    quint64 *ext = _extended_row.data();
+    for (int y = 0; y < _rows; ++y)
+    {
+        ext[0] = fill;
+        std::copy(src.row(y), src.row(y) + n, ext + 1);
+        // pixels beyond the last column are outside the image
+        ext[n] |= fill & ~tail;
+        ext[n+1] = fill;
+        for (std::size_t r = 0; r < _ranges.size(); ++r)
+        {
+            quint64 *h = _horizontal.data() + r*plane + static_cast<std::size_t>(y)*n;
+            const int lo = _ranges[r].first;
+            const int hi = _ranges[r].second;
+            for (int i = 0; i < n; ++i)
+            {
+                quint64 acc = shiftedWord(ext, i, lo);
+                for (int s = lo + 1; s <= hi; ++s)
+                    acc = erode ? (acc & shiftedWord(ext, i, s)) : (acc | shiftedWord(ext, i, s));
+                h[i] = acc;
+            }
+        }
+    }
+
+    // combine the rows of the kernel; rows outside the image change nothing
+    for (int y = 0; y < _rows; ++y)
+    {
+        quint64 *dst = out + static_cast<std::size_t>(y)*n;
+        std::fill(dst, dst + n, fill);
+        for (const auto &seg : _segments)
+        {
+            const int sy = y + seg.dy;
+            if (sy < 0 || sy >= _rows)
+                continue;
+            const quint64 *h = _horizontal.data() + seg.range*plane + static_cast<std::size_t>(sy)*n;
+            if (erode)
+                for (int i = 0; i < n; ++i)
+                    dst[i] &= h[i];
+            else
+                for (int i = 0; i < n; ++i)
+                    dst[i] |= h[i];
+        }
+        if (n > 0)
+            dst[n-1] &= tail;
+    }
+}
+
+void BinaryMask::_setBlurWeights(const cv::Size &ksize, const double &sigma, const int &thresh)
+{
+    if (ksize == _blur_size && sigma == _blur_sigma && thresh == _blur_thresh && !_weights_x.empty())
+        return;
+    CV_Assert(ksize.width % 2 == 1 && ksize.height % 2 == 1 && ksize.width < 128 && ksize.height < 128);
+    _blur_size = ksize;
+    _blur_sigma = sigma;
+    _blur_thresh = thresh;
+
+    // OpenCV blurs 8-bit images by a fixed-point kernel with 8 fractional bits in each direction
+    const auto quantize = [](const int &n, const double &sigma, std::vector<int> &weights) {
+        cv::Mat k = cv::getGaussianKernel(n, sigma, CV_32F);
+        weights.resize(n);
+        for (int i = 0; i < n; ++i)
+            weights[i] = cvRound(k.at<float>(i)*256);
+        // coefficients rounded to 0 at both ends do not count
+        int r = n/2;
+        while (r > 0 && weights[n/2 + r] == 0 && weights[n/2 - r] == 0)
+            --r;
+        weights = std::vector<int>(weights.begin() + n/2 - r, weights.begin() + n/2 + r + 1);
+    };
+    quantize(ksize.width, sigma, _weights_x);
+    quantize(ksize.height, sigma, _weights_y);
+
+    // the blurred value of a 255 pixel is (255*sum + 2^15) >> 16, which passes if it is above thresh
+    _min_sum = ((static_cast<qint64>(thresh) + 1)*65536 - 32768 + 254)/255;
+
+    const int cx = static_cast<int>(_weights_x.size()/2);
+    const int cy = static_cast<int>(_weights_y.size()/2);
+    _core_radius = -1;
+    for (int r = 0; r <= std::min(cx, cy); ++r)
+    {
+        if (static_cast<qint64>(_weights_x[cx+r])*_weights_y[cy+r] < _min_sum)
+            break;
+        _core_radius = r;
+    }
+}
+
+qint64 BinaryMask::_blurredSum(const BinaryMask &src, const int &x, const int &y) const
+{
+    const int rx = static_cast<int>(_weights_x.size()/2);
+    const int ry = static_cast<int>(_weights_y.size()/2);
+    qint64 sum = 0;
+    for (int dy = -ry; dy <= ry; ++dy)
+    {
+        // the default border of cv::GaussianBlur
+        const int sy = cv::borderInterpolate(y + dy, _rows, cv::BORDER_REFLECT_101);
+        int row_sum = 0;
+        for (int dx = -rx; dx <= rx; ++dx)
+            if (src.at(cv::borderInterpolate(x + dx, _cols, cv::BORDER_REFLECT_101), sy))
+                row_sum += _weights_x[rx + dx];
+        sum += static_cast<qint64>(row_sum)*_weights_y[ry + dy];
+    }
+    return sum;
+}
@@ -0,0 +1,150 @@
+#ifndef BINARYMASK_H
+#define BINARYMASK_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The BinaryMask.h file contains the bit-packed binary image on which the hand detector smooths and transforms its skin mask.
+ */
+#include <vector>
+#include <QtGlobal>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief The BinaryMask class is a binary image storing 64 pixels in each machine word.
+ *
+ * Bit `j` of word `i` in a row is the pixel at column `64*i + j`. Bits beyond the last column are always 0.
+ *
+ * The operations give the same results as their OpenCV counterparts on a 0/255 `CV_8UC1` image:
+ *
+ *  - #BinaryMask::erode and #BinaryMask::dilate are `cv::erode` and `cv::dilate` with the default border, i.e. pixels outside the image never
+ *    erode or dilate anything. Each row of the kernel is applied as an AND or OR of shifted words.
+ *  - #BinaryMask::blurThreshold is `cv::GaussianBlur` followed by `cv::threshold` with `cv::THRESH_BINARY`.
+ *    A pixel is set at once if any pixel near enough to pass the threshold alone is set; only the few pixels near the border of a region
+ *    are decided by weighting their neighbourhood. The weights are the 8-bit fixed-point coefficients OpenCV uses to blur 8-bit images.
+ *
+ * **ATTENTION**:
+ *  The operations write into the mask on which they are called and read another one, which must not be the same mask.
+ *  They keep their buffers between calls, so that a mask is not thread-safe.
+ */
+class BinaryMask
+{
+public:
+    BinaryMask();
+
+    /**
+     * @brief create allocates the mask for the given size. The pixels are undefined unless the size is unchanged.
+     */
+    void create(const cv::Size &size);
+    /**
+     * @brief size returns the size of the mask.
+     */
+    cv::Size size() const;
+    /**
+     * @brief empty returns if the mask has no pixel.
+     */
+    bool empty() const;
+    /**
+     * @brief wordsPerRow returns the number of words storing a row.
+     */
+    int wordsPerRow() const;
+    /**
+     * @brief row returns the words of the given row.
+     */
+    inline quint64 *row(const int &y);
+    inline const quint64 *row(const int &y) const;
+    /**
+     * @brief at returns the pixel at the given position.
+     */
+    inline bool at(const int &x, const int &y) const;
+    /**
+     * @brief count returns the number of pixels set.
+     */
+    int count() const;
+
+    /**
+     * @brief pack stores a `CV_8UC1` image into the mask. Nonzero pixels are set.
+     */
+    void pack(const cv::Mat &mask);
+    /**
+     * @brief unpack writes the mask into a `CV_8UC1` image of 0 and 255.
+     */
+    void unpack(cv::Mat &mask) const;
+    /**
+     * @brief unpack writes the rows from `first_row` on into a `CV_8UC1` image of the same width, as many as it has rows.
+     */
+    void unpack(cv::Mat &mask, const int &first_row) const;
+
+    /**
+     * @brief blurThreshold sets the mask to `src` after `cv::GaussianBlur` and `cv::threshold` at `thresh`.
+     * @param src : the mask blurred
+     * @param ksize : size of the Gaussian kernel. Both sides must be odd and less than 128.
+     * @param sigma : standard deviation of the Gaussian kernel in both directions
+     * @param thresh : the threshold applied to the blurred 8-bit value
+     */
+    void blurThreshold(const BinaryMask &src, const cv::Size &ksize, const double &sigma, const int &thresh);
+    /**
+     * @brief erode sets the mask to `src` eroded by the kernel, whose anchor is at its center. It must be less than 128 pixels wide.
+     */
+    void erode(const BinaryMask &src, const cv::Mat &kernel);
+    /**
+     * @brief dilate sets the mask to `src` dilated by the kernel, whose anchor is at its center. It must be less than 128 pixels wide.
+     */
+    void dilate(const BinaryMask &src, const cv::Mat &kernel);
+
+private:
+    struct Segment
+    {
+        int dy;
+        int range;
+    };
+
+    void _setSegments(const cv::Mat &kernel);
+    void _setRectSegments(const int &rx, const int &ry);
+    void _morph(const BinaryMask &src, const bool &erode, quint64 *out);
+    void _setBlurWeights(const cv::Size &ksize, const double &sigma, const int &thresh);
+    qint64 _blurredSum(const BinaryMask &src, const int &x, const int &y) const;
+    inline quint64 _tailMask() const;
+
+    int _rows;
+    int _cols;
+    int _words_per_row;
+    std::vector<quint64> _words;
+
+    // the kernel of the morphological operation as horizontal ranges of each kernel row
+    std::vector<Segment> _segments;
+    std::vector<std::pair<int, int> > _ranges;
+    std::vector<quint64> _horizontal;
+    std::vector<quint64> _extended_row;
+
+    // the quantized Gaussian kernel of the last blur
+    cv::Size _blur_size;
+    double _blur_sigma;
+    int _blur_thresh;
+    std::vector<int> _weights_x;
+    std::vector<int> _weights_y;
+    qint64 _min_sum;
+    int _core_radius;
+    std::vector<quint64> _neighbourhood;
+};
+
+quint64 *BinaryMask::row(const int &y)
+{
+    return _words.data() + static_cast<std::size_t>(y)*_words_per_row;
+}
+
+const quint64 *BinaryMask::row(const int &y) const
+{
+    return _words.data() + static_cast<std::size_t>(y)*_words_per_row;
+}
+
+bool BinaryMask::at(const int &x, const int &y) const
+{
+    return (row(y)[x >> 6] >> (x & 63)) & 1;
+}
+
+quint64 BinaryMask::_tailMask() const
+{
+    return _cols % 64 == 0 ? ~quint64(0) : (quint64(1) << (_cols % 64)) - 1;
+}
+
+#endif // BINARYMASK_H
@@ -0,0 +1,58 @@
+#include "CameraSource.h"
+
+CameraSource::CameraSource(const int &device, const size_t &fps) :
+    _device(device),
+    _fps(fps)
+{}
+
+bool CameraSource::open()
+{
+    if (_camera.isOpened())
+        return true;
+    _camera.open(_device);
+    if (!_camera.isOpened())
+        return false;
+    _camera.set(cv::CAP_PROP_FPS, _fps);
+    return true;
+}
+
+bool CameraSource::isOpened() const
+{
+    return _camera.isOpened();
+}
+
+void CameraSource::release()
+{
+    _camera.release();
+}
+
+bool CameraSource::read(cv::Mat &frame)
+{
+    return _camera.read(frame) && !frame.empty();
+}
+
+bool CameraSource::atEnd() const
+{
+    return false;
+}
+
+bool CameraSource::isLive() const
+{
+    return true;
+}
+
+cv::Size CameraSource::frameSize() const
+{
+    // cv::VideoCapture::get is not const in OpenCV 3
+    auto &camera = const_cast<cv::VideoCapture &>(_camera);
+    return cv::Size(static_cast<int>(camera.get(cv::CAP_PROP_FRAME_WIDTH)),
+                    static_cast<int>(camera.get(cv::CAP_PROP_FRAME_HEIGHT)));
+}
+
+bool CameraSource::setFrameRate(const double &fps)
+{
+    if (!_camera.isOpened())
+        return false;
+    // not every camera backend accepts a new FPS while streaming
+    return _camera.set(cv::CAP_PROP_FPS, fps > 0 ? fps : _fps);
+}
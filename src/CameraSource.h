@@ -0,0 +1,45 @@
+#ifndef CAMERASOURCE_H
+#define CAMERASOURCE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The CameraSource.h file contains the frame source who reads frames from a camera via OpenCV.
+ */
+#include <opencv2/opencv.hpp>
+
+#include "global.h"
+#include "FrameSourceInterface.h"
+
+/**
+ * @brief The CameraSource class reads frames from a camera via `cv::VideoCapture`.
+ */
+class CameraSource : public FrameSourceInterface
+{
+public:
+    /**
+     * @param device : index of the camera
+     * @param fps : the FPS requested from the camera
+     */
+    explicit CameraSource(const int &device = 0, const size_t &fps = CAMERA_FPS);
+
+    bool open() override;
+    bool isOpened() const override;
+    void release() override;
+    bool read(cv::Mat &frame) override;
+    bool atEnd() const override;
+    bool isLive() const override;
+    cv::Size frameSize() const override;
+    bool setFrameRate(const double &fps) override;
+
+protected:
+    /**
+     * @brief _camera is the camera opened.
+     */
+    cv::VideoCapture _camera;
+
+private:
+    int _device;
+    size_t _fps;
+};
+
+#endif // CAMERASOURCE_H
@@ -0,0 +1,97 @@
+#include "CaptureGeometry.h"
+
+#include <cmath>
+
+CaptureGeometry::CaptureGeometry(const cv::Size &sensor_size, const cv::Size &view_size, const cv::Rect &roi) :
+    sensor_size(sensor_size),
+    view_size(_viewSize(sensor_size, view_size)),
+    roi(roi & cv::Rect(cv::Point(0, 0), _viewSize(sensor_size, view_size))),
+    sensor_roi(_sensor_roi),
+    _requested_view_size(view_size),
+    _requested_roi(roi)
+{
+    // the width after resizing the sensor frame to the view height with the aspect ratio kept
+    const int resized_width = sensor_size.width*this->view_size.height/sensor_size.height;
+    // crop the center and flip: resized_x = (resized_width - view_width)/2 + view_width - 1 - view_x
+    _offset_x = (resized_width - this->view_size.width)/2 + this->view_size.width - 1;
+    _scale_x = static_cast<float>(sensor_size.width)/resized_width;
+    _scale_y = static_cast<float>(sensor_size.height)/this->view_size.height;
+
+    _sensor_roi = mapToSensor(this->roi);
+    if (this->roi.area() > 0)
+        _buildMaps(this->roi, _roi_map1, _roi_map2);
+}
+
+bool CaptureGeometry::matches(const cv::Size &sensor_size, const cv::Size &view_size, const cv::Rect &roi) const
+{
+    return this->sensor_size == sensor_size && _requested_view_size == view_size && _requested_roi == roi;
+}
+
+cv::Point2f CaptureGeometry::mapToSensor(const cv::Point2f &view_point) const
+{
+    return cv::Point2f((_offset_x - view_point.x + 0.5f)*_scale_x - 0.5f,
+                       (view_point.y + 0.5f)*_scale_y - 0.5f);
+}
+
+cv::Rect CaptureGeometry::mapToSensor(const cv::Rect &view_rect) const
+{
+    if (view_rect.area() <= 0)
+        return cv::Rect();
+    // the view is flipped, such that its right border comes from the left side of the sensor frame
+    const int left   = static_cast<int>(std::floor(_sensorX(view_rect.x + view_rect.width - 1)));
+    const int right  = static_cast<int>(std::floor(_sensorX(view_rect.x))) + 1;
+    const int top    = static_cast<int>(std::floor(_sensorY(view_rect.y)));
+    const int bottom = static_cast<int>(std::floor(_sensorY(view_rect.y + view_rect.height - 1))) + 1;
+    return cv::Rect(left, top, right - left + 1, bottom - top + 1) & cv::Rect(cv::Point(0, 0), sensor_size);
+}
+
+void CaptureGeometry::extractRoi(const cv::Mat &sensor_frame, cv::Mat &roi_img) const
+{
+    if (_roi_map1.empty())
+    {
+        roi_img.release();
+        return;
+    }
+    cv::remap(sensor_frame, roi_img, _roi_map1, _roi_map2, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+}
+
+void CaptureGeometry::renderView(const cv::Mat &sensor_frame, cv::Mat &view_img) const
+{
+    std::call_once(_view_maps_built, [this]{
+        _buildMaps(cv::Rect(cv::Point(0, 0), view_size), _view_map1, _view_map2);
+    });
+    cv::remap(sensor_frame, view_img, _view_map1, _view_map2, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+}
+
+cv::Size CaptureGeometry::_viewSize(const cv::Size &sensor_size, const cv::Size &view_size)
+{
+    return view_size.width > 0 && view_size.height > 0 ? view_size : sensor_size;
+}
+
+float CaptureGeometry::_sensorX(const int &view_x) const
+{
+    return (_offset_x - view_x + 0.5f)*_scale_x - 0.5f;
+}
+
+float CaptureGeometry::_sensorY(const int &view_y) const
+{
+    return (view_y + 0.5f)*_scale_y - 0.5f;
+}
+
+void CaptureGeometry::_buildMaps(const cv::Rect &view_rect, cv::Mat &map1, cv::Mat &map2) const
+{
+    // the mapping is separable; compute one row and one column and spread them
+    cv::Mat map_x(view_rect.height, view_rect.width, CV_32FC1);
+    cv::Mat map_y(view_rect.height, view_rect.width, CV_32FC1);
+    float *row_x = map_x.ptr<float>(0);
+    for (int c = 0; c < view_rect.width; ++c)
+        row_x[c] = _sensorX(view_rect.x + c);
+    for (int r = 0; r < view_rect.height; ++r)
+    {
+        if (r > 0)
+            std::copy(row_x, row_x + view_rect.width, map_x.ptr<float>(r));
+        map_y.row(r).setTo(_sensorY(view_rect.y + r));
+    }
+    // fixed-point maps make cv::remap considerably faster
+    cv::convertMaps(map_x, map_y, map1, map2, CV_16SC2);
+}
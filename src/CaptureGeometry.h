@@ -0,0 +1,99 @@
+#ifndef CAPTUREGEOMETRY_H
+#define CAPTUREGEOMETRY_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The CaptureGeometry.h file contains the planner who maps the tracking window onto the frame read from the camera.
+ */
+#include <mutex>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief The CaptureGeometry class describes how a frame read from the camera is fitted to the tracking window.
+ *
+ * The frame read from the camera (the sensor frame) is resized to the height of the tracking window with its aspect ratio kept,
+ * cropped at the center to the width of the tracking window and flipped horizontally.
+ * Instead of performing those steps one after another on the whole frame,
+ * the class precomputes, for every pixel of the region of interesting on the tracking window, the sensor position it comes from.
+ * #CaptureGeometry::extractRoi then produces the detector's input by a single `cv::remap` pass over only the pixels of the region of interesting.
+ * The whole tracking window is produced by #CaptureGeometry::renderView only when it is going to be displayed.
+ *
+ * The bilinear sampling positions are the same as those used by `cv::resize` with `cv::INTER_LINEAR`.
+ *
+ * An instance is immutable once constructed, except for the lazily built maps of the whole view,
+ * and can be shared between threads.
+ */
+class CaptureGeometry
+{
+public:
+    /**
+     * @param sensor_size : size of the frames read from the camera
+     * @param view_size : size of the tracking window. An empty size means to keep the sensor size.
+     * @param roi : region of interesting on the tracking window. It is clamped into the tracking window.
+     */
+    CaptureGeometry(const cv::Size &sensor_size, const cv::Size &view_size, const cv::Rect &roi);
+
+    /**
+     * @brief sensor_size is the size of the frames read from the camera.
+     */
+    const cv::Size sensor_size;
+    /**
+     * @brief view_size is the size of the tracking window.
+     */
+    const cv::Size view_size;
+    /**
+     * @brief roi is the region of interesting on the tracking window.
+     */
+    const cv::Rect roi;
+    /**
+     * @brief sensor_roi is the smallest region on the sensor frame who contains all pixels read by #CaptureGeometry::extractRoi .
+     */
+    const cv::Rect &sensor_roi;
+
+    /**
+     * @brief matches returns if the geometry was planned for the given parameters.
+     */
+    bool matches(const cv::Size &sensor_size, const cv::Size &view_size, const cv::Rect &roi) const;
+    /**
+     * @brief mapToSensor maps a point on the tracking window to the sensor frame.
+     */
+    cv::Point2f mapToSensor(const cv::Point2f &view_point) const;
+    /**
+     * @brief mapToSensor maps a rectangle on the tracking window to the smallest region on the sensor frame who contains all pixels sampled for it.
+     */
+    cv::Rect mapToSensor(const cv::Rect &view_rect) const;
+    /**
+     * @brief extractRoi produces the region of interesting of the tracking window from a sensor frame.
+     * @param sensor_frame : a frame read from the camera whose size is #CaptureGeometry::sensor_size
+     * @param roi_img : the place where the image of #CaptureGeometry::roi will be stored
+     */
+    void extractRoi(const cv::Mat &sensor_frame, cv::Mat &roi_img) const;
+    /**
+     * @brief renderView produces the whole tracking window from a sensor frame.
+     * @param sensor_frame : a frame read from the camera whose size is #CaptureGeometry::sensor_size
+     * @param view_img : the place where the image of the tracking window will be stored
+     */
+    void renderView(const cv::Mat &sensor_frame, cv::Mat &view_img) const;
+
+private:
+    static cv::Size _viewSize(const cv::Size &sensor_size, const cv::Size &view_size);
+    float _sensorX(const int &view_x) const;
+    float _sensorY(const int &view_y) const;
+    void _buildMaps(const cv::Rect &view_rect, cv::Mat &map1, cv::Mat &map2) const;
+
+    const cv::Size _requested_view_size;
+    const cv::Rect _requested_roi;
+    // sensor_x = (_offset_x - view_x + 0.5) * _scale_x - 0.5
+    float _offset_x;
+    float _scale_x;
+    float _scale_y;
+    cv::Rect _sensor_roi;
+
+    cv::Mat _roi_map1;
+    cv::Mat _roi_map2;
+    mutable std::once_flag _view_maps_built;
+    mutable cv::Mat _view_map1;
+    mutable cv::Mat _view_map2;
+};
+
+#endif // CAPTUREGEOMETRY_H
@@ -95,7 +95,7 @@ public:
      * @param tracked_pos_x : the horizontal position of the traked point which is used for control the cursor
      * @param tracked_pos_y : the vertical position of the traked point which is used for control the cursor
      *
-     * @see #HandDetector::tracked_point
+     * @see #HandObservation::tracked_point
      */
     void input(const int &label_index,
                const float &tracked_pos_x,
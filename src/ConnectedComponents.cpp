@@ -0,0 +1,119 @@
+#include "ConnectedComponents.h"
+
+#include <cstring>
+
+namespace
+{
+
+inline quint64 eightPixels(const uchar *p)
+{
+    quint64 pixels;
+    std::memcpy(&pixels, p, sizeof(pixels));
+    return pixels;
+}
+
+}
+
+void ConnectedComponents::label(const cv::Mat &mask, const cv::Point &offset)
+{
+    CV_Assert(mask.type() == CV_8UC1);
+    _offset = offset;
+    _runs.clear();
+    _components.clear();
+
+    int prev_first = 0, prev_last = 0; // the runs of the previous row
+    for (int y = 0; y < mask.rows; ++y)
+    {
+        const uchar *p = mask.ptr<uchar>(y);
+        const int first = static_cast<int>(_runs.size());
+        int x = 0;
+        while (x < mask.cols)
+        {
+            while (x + 8 <= mask.cols && eightPixels(p + x) == 0)
+                x += 8;
+            while (x < mask.cols && p[x] == 0)
+                ++x;
+            if (x == mask.cols)
+                break;
+            Run run;
+            run.y = y;
+            run.start = x;
+            while (x + 8 <= mask.cols && eightPixels(p + x) == ~quint64(0))
+                x += 8;
+            while (x < mask.cols && p[x] != 0)
+                ++x;
+            run.end = x - 1;
+            run.parent = static_cast<int>(_runs.size());
+            _runs.push_back(run);
+        }
+        const int last = static_cast<int>(_runs.size());
+
+        // join the runs touching those of the previous row, both lists being sorted
+        for (int i = first, j = prev_first; i < last && j < prev_last;)
+        {
+            if (_runs[j].end < _runs[i].start - 1)
+                ++j;
+            else if (_runs[i].end < _runs[j].start - 1)
+                ++i;
+            else
+            {
+                const int a = _find(i), b = _find(j);
+                if (a != b)
+                    _runs[std::max(a, b)].parent = std::min(a, b);
+                // the run ending first cannot touch the next run of the other row
+                if (_runs[i].end < _runs[j].end)
+                    ++i;
+                else
+                    ++j;
+            }
+        }
+        prev_first = first;
+        prev_last = last;
+    }
+
+    _component_of_root.assign(_runs.size(), -1);
+    for (std::size_t i = 0; i < _runs.size(); ++i)
+    {
+        auto &run = _runs[i];
+        // the parent comes before, such that it already points to the root
+        run.parent = _runs[run.parent].parent;
+        int &c = _component_of_root[run.parent];
+        const cv::Rect bound(run.start + offset.x, run.y + offset.y, run.end - run.start + 1, 1);
+        if (c == -1)
+        {
+            c = static_cast<int>(_components.size());
+            _components.push_back(Component{0, bound});
+        }
+        _components[c].area += bound.width;
+        _components[c].bound |= bound;
+        run.component = c;
+    }
+}
+
+const std::vector<ConnectedComponents::Component> &ConnectedComponents::components() const
+{
+    return _components;
+}
+
+void ConnectedComponents::draw(const int &index, cv::Mat &img, const cv::Point &origin) const
+{
+    CV_Assert(img.type() == CV_8UC1 && (_components[index].bound & cv::Rect(origin, img.size())) == _components[index].bound);
+    const cv::Point shift = _offset - origin;
+    for (const auto &run : _runs)
+    {
+        if (run.component != index)
+            continue;
+        uchar *row = img.ptr<uchar>(run.y + shift.y);
+        std::memset(row + run.start + shift.x, 255, run.end - run.start + 1);
+    }
+}
+
+int ConnectedComponents::_find(int run)
+{
+    while (_runs[run].parent != run)
+    {
+        _runs[run].parent = _runs[_runs[run].parent].parent;
+        run = _runs[run].parent;
+    }
+    return run;
+}
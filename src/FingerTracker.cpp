@@ -0,0 +1,97 @@
+#include "FingerTracker.h"
+
+#include <algorithm>
+
+FingerTracker::FingerTracker() :
+    _next_id(0)
+{}
+
+void FingerTracker::update(const std::vector<cv::Point> &tops, std::vector<int> &ids)
+{
+    const int n_fingers = static_cast<int>(_fingers.size());
+    const int n_tops = static_cast<int>(tops.size());
+
+    // all the pairs within the gate, the closest first
+    _pairs.clear();
+    for (int f = 0; f < n_fingers; ++f)
+    {
+        const cv::Point expected = _fingers[f].position + _fingers[f].velocity;
+        for (int t = 0; t < n_tops; ++t)
+        {
+            const cv::Point d = tops[t] - expected;
+            const int squared_dist = d.x*d.x + d.y*d.y;
+            if (squared_dist < FINGER_TRACKING_GATE*FINGER_TRACKING_GATE)
+                _pairs.push_back(Pair{squared_dist, f, t});
+        }
+    }
+    std::sort(_pairs.begin(), _pairs.end(),
+              [](const Pair &lhs, const Pair &rhs) -> bool
+    {
+        return lhs.squared_dist < rhs.squared_dist;
+    });
+
+    _finger_assigned.assign(n_fingers, 0);
+    _top_assigned.assign(n_tops, 0);
+    ids.resize(n_tops);
+    for (const auto &p : _pairs)
+    {
+        if (_finger_assigned[p.finger] || _top_assigned[p.top])
+            continue;
+        _finger_assigned[p.finger] = 1;
+        _top_assigned[p.top] = 1;
+        auto &finger = _fingers[p.finger];
+        finger.velocity = tops[p.top] - finger.position;
+        finger.position = tops[p.top];
+        finger.missed = 0;
+        ids[p.top] = finger.id;
+    }
+
+    // the fingers missed keep moving, until they are forgotten
+    int kept = 0;
+    for (int f = 0; f < n_fingers; ++f)
+    {
+        auto &finger = _fingers[f];
+        if (!_finger_assigned[f])
+        {
+            if (++finger.missed > FINGER_TRACKING_MISSES)
+                continue;
+            finger.position += finger.velocity;
+        }
+        _fingers[kept++] = finger;
+    }
+    _fingers.resize(kept);
+
+    for (int t = 0; t < n_tops; ++t)
+    {
+        if (_top_assigned[t])
+            continue;
+        _fingers.push_back(Finger{_next_id, tops[t], cv::Point(), 0});
+        ids[t] = _next_id++;
+    }
+}
+
+void FingerTracker::predict(std::vector<cv::Point> &tops, std::vector<int> &ids)
+{
+    tops.clear();
+    ids.clear();
+    for (auto &finger : _fingers)
+    {
+        finger.position += finger.velocity;
+        if (finger.missed == 0)
+        {
+            tops.push_back(finger.position);
+            ids.push_back(finger.id);
+        }
+    }
+}
+
+void FingerTracker::clear()
+{
+    _fingers.clear();
+    _next_id = 0;
+}
+
+const std::vector<FingerTracker::Finger> &FingerTracker::fingers() const
+{
+    return _fingers;
+}
@@ -0,0 +1,86 @@
+#ifndef FINGERTRACKER_H
+#define FINGERTRACKER_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The FingerTracker.h file contains the tracker who follows the finger tops across frames.
+ */
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "global.h"
+
+/**
+ * @brief The FingerTracker class matches the finger tops found on each frame to the fingers of the previous frames, giving each finger a stable id.
+ *
+ * A finger is expected at its last position moved by its velocity. The finger tops are assigned greedily, the closest pair of a finger
+ * and a finger top first, and only if their distance is smaller than #FINGER_TRACKING_GATE . A finger top left unassigned starts a new finger,
+ * while a finger left unassigned keeps moving by its velocity and is forgotten after #FINGER_TRACKING_MISSES frames.
+ *
+ * The buffers are kept between calls, so that tracking a few fingers allocates nothing.
+ */
+class FingerTracker
+{
+public:
+    /**
+     * @brief Finger is a tracked finger.
+     */
+    struct Finger
+    {
+        /**
+         * @brief id is the identifier of the finger, unique until the tracker is cleared.
+         */
+        int id;
+        /**
+         * @brief position is the last estimation of the finger top.
+         */
+        cv::Point position;
+        /**
+         * @brief velocity is the moving of the finger top between its last two estimations.
+         */
+        cv::Point velocity;
+        /**
+         * @brief missed is the number of frames since the finger top was found for the last time.
+         */
+        int missed;
+    };
+
+    FingerTracker();
+
+    /**
+     * @brief update assigns the finger tops of a new frame to the tracked fingers.
+     * @param tops : the finger tops
+     * @param ids : the place where the id of the finger of each finger top will be stored
+     */
+    void update(const std::vector<cv::Point> &tops, std::vector<int> &ids);
+    /**
+     * @brief predict moves every finger by its velocity, for a frame on which the finger tops are not estimated.
+     * @param tops : the place where the predicted finger tops of the fingers found on the last frame will be stored
+     * @param ids : the place where their ids will be stored
+     */
+    void predict(std::vector<cv::Point> &tops, std::vector<int> &ids);
+    /**
+     * @brief clear forgets all the fingers.
+     */
+    void clear();
+    /**
+     * @brief fingers returns the tracked fingers, including those missed recently.
+     */
+    const std::vector<Finger> &fingers() const;
+
+private:
+    struct Pair
+    {
+        int squared_dist;
+        int finger;
+        int top;
+    };
+
+    int _next_id;
+    std::vector<Finger> _fingers;
+    std::vector<Pair> _pairs;
+    std::vector<uchar> _finger_assigned;
+    std::vector<uchar> _top_assigned;
+};
+
+#endif // FINGERTRACKER_H
@@ -0,0 +1,129 @@
+#ifndef FRAMEMAILBOX_H
+#define FRAMEMAILBOX_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The FrameMailbox.h file contains a lock-free single-slot mailbox who always hands over the newest item.
+ */
+#include <atomic>
+
+/**
+ * @brief The FrameMailbox template is a lock-free mailbox between a single producer and a single consumer who keeps only the newest item.
+ *
+ * **ATTENTION**:
+ *  Only one thread may call #FrameMailbox::post and only one (other) thread may call #FrameMailbox::take.
+ *
+ * It is a triple buffer: the producer writes the back slot, the consumer reads the front slot,
+ * and the two exchange their slot with the middle one atomically.
+ * Posting a new item while the previous one has not been taken yet replaces the previous one, which is counted as dropped,
+ * unless the producer asks not to drop anything.
+ *
+ * @tparam T : type of the items. It must be default constructible and movable.
+ */
+template <typename T>
+class FrameMailbox
+{
+public:
+    FrameMailbox();
+    FrameMailbox(const FrameMailbox &) = delete;
+    FrameMailbox &operator=(const FrameMailbox &) = delete;
+
+    /**
+     * @brief post hands over an item to the consumer. Producer only.
+     * @param item : the item which will be moved into the mailbox
+     * @param drop_pending : if an item not yet taken by the consumer may be dropped and replaced
+     * @retval true : if the item was posted
+     * @retval false : if `drop_pending` is `false` and an item is still pending. `item` is left untouched.
+     */
+    bool post(T &&item, const bool &drop_pending = true);
+    /**
+     * @brief take takes the newest item posted. Consumer only.
+     * @param item : the place where the item will be moved to
+     * @retval true : if an item was taken
+     * @retval false : if nothing new was posted since the last call
+     */
+    bool take(T &item);
+    /**
+     * @brief pending returns if an item has been posted but not yet taken.
+     */
+    bool pending() const;
+    /**
+     * @brief dropped returns how many items were replaced before being taken.
+     */
+    unsigned long long dropped() const;
+    /**
+     * @brief clear drops the pending item and resets the counter of dropped items.
+     *
+     * **ATTENTION**:
+     *  It must not be called while the producer or the consumer is working on the mailbox.
+     */
+    void clear();
+
+private:
+    static const int FRESH = 0x4;
+    static const int INDEX = 0x3;
+
+    T _slots[3];
+    int _back;  // owned by the producer
+    int _front; // owned by the consumer
+    std::atomic<int> _middle;
+    std::atomic<unsigned long long> _dropped;
+};
+
+template <typename T>
+FrameMailbox<T>::FrameMailbox() :
+    _back(0),
+    _front(1),
+    _middle(2),
+    _dropped(0)
+{}
+
+template <typename T>
+bool FrameMailbox<T>::post(T &&item, const bool &drop_pending)
+{
+    // only the consumer clears the fresh flag, so nothing can be dropped after this check
+    if (!drop_pending && (_middle.load(std::memory_order_acquire) & FRESH))
+        return false;
+    _slots[_back] = std::move(item);
+    const int prev = _middle.exchange(_back | FRESH, std::memory_order_acq_rel);
+    if (prev & FRESH)
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+    _back = prev & INDEX;
+    return true;
+}
+
+template <typename T>
+bool FrameMailbox<T>::take(T &item)
+{
+    if (!(_middle.load(std::memory_order_acquire) & FRESH))
+        return false;
+    // the producer may have posted again in between; the exchange still gets the newest one
+    _front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX;
+    item = std::move(_slots[_front]);
+    // release whatever the slot still references (e.g. the buffer of a cv::Mat)
+    _slots[_front] = T();
+    return true;
+}
+
+template <typename T>
+bool FrameMailbox<T>::pending() const
+{
+    return _middle.load(std::memory_order_acquire) & FRESH;
+}
+
+template <typename T>
+unsigned long long FrameMailbox<T>::dropped() const
+{
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+void FrameMailbox<T>::clear()
+{
+    for (auto &s : _slots)
+        s = T();
+    _middle.store(_middle.load() & INDEX);
+    _dropped.store(0);
+}
+
+#endif // FRAMEMAILBOX_H
@@ -0,0 +1,379 @@
+#include "FramePipeline.h"
+
+#include <algorithm>
+#include <iterator>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+FramePipeline::FramePipeline(HandDetector *hand_detector,
+                             SampleCollector *sample_collector,
+                             GestureAnalystInterface *gesture_analyst,
+                             QObject *parent) :
+    QObject(parent),
+    _hand_detector(hand_detector),
+    _sample_collector(sample_collector),
+    _gesture_analyst(gesture_analyst),
+    _source(nullptr),
+    _stage_profiler(nullptr),
+    _capture_stage(new Stage([this]{ _captureLoop(); })),
+    _detection_stage(new Stage([this]{ _detectionLoop(); })),
+    _inference_stage(new Stage([this]{ _inferenceLoop(); })),
+    _processed_frames(PIPELINE_QUEUE_CAPACITY),
+    _running(false),
+    _stopping(false),
+    _notified(false),
+    _detecting(false),
+    _recognizing(false),
+    _sampling(false),
+    _monitoring(false),
+    _drop_policy(DROP_OLDEST),
+    _standby_timeout(0),
+    _standby(false),
+    _rate_lowered(false),
+    _observation_pool(SampleCollector::sample_image_size),
+    _frame_width(0),
+    _frame_height(0)
+{}
+
+FramePipeline::~FramePipeline()
+{
+    stop();
+    delete _capture_stage;
+    delete _detection_stage;
+    delete _inference_stage;
+}
+
+void FramePipeline::start(FrameSourceInterface *source)
+{
+    if (_running)
+        return;
+    _source = source;
+    _captured_frame.clear();
+    _detected_frame.clear();
+    _stopping = false;
+    _notified = false;
+    _standby = false;
+    _rate_lowered = false;
+    _running = true;
+    // the detector lives in the detection thread such that setting changes arrive between two frames
+    _hand_detector->moveToThread(_detection_stage);
+    _inference_stage->start();
+    _detection_stage->start();
+    _capture_stage->start();
+}
+
+void FramePipeline::stop()
+{
+    if (!_running)
+        return;
+    _stopping = true;
+    _capture_stage->wait();
+    _detection_stage->wait();
+    _inference_stage->wait();
+    _processed_frames.clear();
+    if (_rate_lowered)
+        _source->setFrameRate(0);
+    _rate_lowered = false;
+    _standby = false;
+    _running = false;
+}
+
+bool FramePipeline::isRunning() const
+{
+    return _running;
+}
+
+bool FramePipeline::takeFrame(Frame &frame)
+{
+    if (_processed_frames.pop(frame))
+        return true;
+    _notified = false;
+    // catch the frame pushed right before the flag was reset
+    return _processed_frames.pop(frame);
+}
+
+void FramePipeline::setFrameGeometry(const int &width, const int &height)
+{
+    QMutexLocker locker(&_geometry_mutex);
+    _frame_width = width;
+    _frame_height = height;
+}
+
+void FramePipeline::setRoi(const cv::Rect &roi)
+{
+    QMutexLocker locker(&_geometry_mutex);
+    _roi = roi;
+}
+
+void FramePipeline::setDetecting(const bool &detecting)
+{
+    _detecting = detecting;
+}
+
+void FramePipeline::setRecognizing(const bool &recognizing)
+{
+    _recognizing = recognizing;
+}
+
+void FramePipeline::setSampling(const bool &sampling)
+{
+    _sampling = sampling;
+}
+
+void FramePipeline::setMonitoring(const bool &monitoring)
+{
+    _monitoring = monitoring;
+}
+
+void FramePipeline::setDropPolicy(const DROP_POLICY &policy)
+{
+    _drop_policy = policy;
+}
+
+quint64 FramePipeline::droppedFrames() const
+{
+    return _captured_frame.dropped() + _detected_frame.dropped();
+}
+
+void FramePipeline::setStageProfiler(StageProfiler *profiler)
+{
+    _stage_profiler = profiler;
+}
+
+void FramePipeline::setStandbyTimeout(const int &ms)
+{
+    _standby_timeout = ms;
+}
+
+bool FramePipeline::isStandingBy() const
+{
+    return _standby;
+}
+
+void FramePipeline::_captureLoop()
+{
+    quint64 id = 0;
+    std::shared_ptr<const CaptureGeometry> geometry;
+    Frame frame;
+    bool standby = false;
+    QElapsedTimer standby_clock;
+    while (!_stopping)
+    {
+        if (standby != _standby)
+        {
+            standby = _standby;
+            // ask the source to slow down; skip frames by ourselves if it cannot
+            if (standby)
+                _rate_lowered = _source->setFrameRate(STANDBY_FPS);
+            else if (_rate_lowered)
+                _rate_lowered = !_source->setFrameRate(0);
+            standby_clock.invalidate();
+        }
+        if (standby && !_rate_lowered && standby_clock.isValid())
+        {
+            const qint64 wait = 1000000/STANDBY_FPS - standby_clock.nsecsElapsed()/1000;
+            if (wait > 0)
+            {
+                // leave the standby without waiting for the whole period
+                QThread::usleep(static_cast<unsigned long>(std::min<qint64>(wait, 10000)));
+                continue;
+            }
+        }
+
+        // never write into the buffers of the frame handed over last time
+        frame = Frame();
+        QElapsedTimer timer;
+        timer.start();
+        if (!_source->read(frame.raw_frame) || frame.raw_frame.empty())
+        {
+            if (_source->atEnd())
+                emit sourceFinished(id);
+            else
+                emit cameraFailed();
+            return;
+        }
+        frame.read_us = timer.nsecsElapsed()/1000;
+        _profile(StageProfiler::STAGE_CAMERA_READ, frame.read_us);
+        if (standby)
+            standby_clock.start();
+        cv::Size view_size;
+        cv::Rect roi;
+        {
+            QMutexLocker locker(&_geometry_mutex);
+            view_size = cv::Size(_frame_width, _frame_height);
+            roi = _roi;
+        }
+        // the maps are only rebuilt when the camera, the tracking window or the region of interesting changes
+        if (!geometry || !geometry->matches(frame.raw_frame.size(), view_size, roi))
+            geometry = std::make_shared<const CaptureGeometry>(frame.raw_frame.size(), view_size, roi);
+        timer.start();
+        frame.geometry = geometry;
+        frame.roi = geometry->roi;
+        geometry->extractRoi(frame.raw_frame, frame.roi_img);
+        frame.geometry_us = timer.nsecsElapsed()/1000;
+        _profile(StageProfiler::STAGE_CROP, frame.geometry_us);
+        frame.id = ++id;
+
+        if (!_handOver(_captured_frame, frame))
+            return;
+    }
+}
+
+void FramePipeline::_detectionLoop()
+{
+    Frame frame;
+    bool standby_allowed = false;
+    QElapsedTimer last_presence;
+    while (!_stopping)
+    {
+        // deliver the queued calls to the slots of the hand detector
+        QCoreApplication::processEvents();
+
+        if (!_captured_frame.take(frame))
+        {
+            _idle();
+            continue;
+        }
+
+        const bool allowed = _standby_timeout > 0 && _detecting && !_monitoring
+                && !_hand_detector->waitingBackground() && _source->isLive();
+        if (allowed != standby_allowed)
+        {
+            standby_allowed = allowed;
+            _standby = false;
+            last_presence.start();
+        }
+        if (_standby && !frame.roi_img.empty())
+        {
+            QElapsedTimer timer;
+            timer.start();
+            frame.presence_checked = true;
+            if (_hand_detector->checkPresence(frame.roi_img, STANDBY_PRESENCE_SCALE))
+            {
+                frame.presence_checked = false;
+                _standby = false;
+                last_presence.start();
+            }
+            _profile(StageProfiler::STAGE_PRESENCE_CHECK, timer.nsecsElapsed()/1000);
+        }
+
+        if ((_detecting || _monitoring || _hand_detector->waitingBackground()) && !frame.presence_checked && !frame.roi_img.empty())
+        {
+            QElapsedTimer timer;
+            timer.start();
+            frame.examined = true;
+            // the ROI image of a frame is never changed afterwards
+            frame.detected = _hand_detector->detectShared(frame.roi_img);
+            _profile(StageProfiler::STAGE_PREPROCESSING, _hand_detector->preprocessingTime());
+            _profile(StageProfiler::STAGE_FINGER_EXTRACTION, _hand_detector->fingerExtractionTime());
+            if (frame.detected)
+            {
+                last_presence.start();
+                _hand_detector->observe(frame.observation);
+                // the pooled crop is resized from the view into the detector, which is only copied if the hand image is consumed
+                if (_sampling || _monitoring)
+                    frame.extracted_img = _hand_detector->extractedImage().clone();
+                QElapsedTimer resize_timer;
+                resize_timer.start();
+                auto crop = _observation_pool.acquireCrop();
+                _sample_collector->resizeSample(_hand_detector->extractedImage(), *crop);
+                frame.observation.crop = std::move(crop);
+                // the other hands, each with its own hand image
+                frame.extra_observations.resize(_hand_detector->handCount() - 1);
+                for (int h = 1; h < _hand_detector->handCount(); ++h)
+                {
+                    auto &observation = frame.extra_observations[h - 1];
+                    _hand_detector->observe(observation, h);
+                    auto extra_crop = _observation_pool.acquireCrop();
+                    _sample_collector->resizeSample(_hand_detector->extractedImage(h), *extra_crop);
+                    observation.crop = std::move(extra_crop);
+                }
+                _profile(StageProfiler::STAGE_RESIZE_SAMPLE, resize_timer.nsecsElapsed()/1000);
+            }
+            frame.detection_us = timer.nsecsElapsed()/1000;
+            if (_monitoring)
+            {
+                frame.filtered_img = _hand_detector->filteredImage().clone();
+                frame.hand_contour = _hand_detector->handContour();
+            }
+            if (standby_allowed && !frame.detected && last_presence.elapsed() >= _standby_timeout)
+                _standby = true;
+        }
+
+        if (!_handOver(_detected_frame, frame))
+            break;
+        frame = Frame();
+    }
+    _hand_detector->moveToThread(thread());
+}
+
+void FramePipeline::_inferenceLoop()
+{
+    Frame frame;
+    // the hand images of a frame with several hands, kept such that only their headers are copied
+    std::vector<cv::Mat> crops;
+    while (!_stopping)
+    {
+        if (!_detected_frame.take(frame))
+        {
+            _idle();
+            continue;
+        }
+        if (_recognizing && frame.detected)
+        {
+            QElapsedTimer timer;
+            timer.start();
+            if (frame.extra_observations.empty())
+                frame.predictions = _gesture_analyst->analyze(*frame.observation.crop, _predictions_per_frame);
+            else
+            {
+                crops.clear();
+                crops.push_back(*frame.observation.crop);
+                for (const auto &observation : frame.extra_observations)
+                    crops.push_back(*observation.crop);
+                auto predictions = _gesture_analyst->analyzeBatch(crops, _predictions_per_frame);
+                if (predictions.size() == crops.size())
+                {
+                    frame.predictions = std::move(predictions.front());
+                    frame.extra_predictions.assign(std::make_move_iterator(predictions.begin() + 1),
+                                                   std::make_move_iterator(predictions.end()));
+                }
+            }
+            frame.analyzed = !frame.predictions.empty();
+            frame.inference_us = timer.nsecsElapsed()/1000;
+            _profile(StageProfiler::STAGE_FORWARD, frame.inference_us);
+        }
+
+        while (!_processed_frames.push(std::move(frame)))
+        {
+            if (_stopping)
+                return;
+            _idle();
+        }
+        if (!_notified.exchange(true))
+            emit frameProcessed();
+    }
+}
+
+void FramePipeline::_profile(const StageProfiler::STAGE &stage, const qint64 &us)
+{
+    if (_stage_profiler != nullptr)
+        _stage_profiler->record(stage, us);
+}
+
+void FramePipeline::_idle()
+{
+    QThread::usleep(PIPELINE_IDLE_WAIT);
+}
+
+bool FramePipeline::_handOver(FrameMailbox<Frame> &mailbox, Frame &frame)
+{
+    // the policy is read on every attempt such that a waiting stage starts dropping as soon as the policy changes
+    while (!mailbox.post(std::move(frame), _drop_policy == DROP_OLDEST && _source->isLive()))
+    {
+        if (_stopping)
+            return false;
+        _idle();
+    }
+    return true;
+}
@@ -0,0 +1,372 @@
+#ifndef FRAMEPIPELINE_H
+#define FRAMEPIPELINE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The FramePipeline.h file contains the staged, multi-threaded pipeline who captures frames from the camera and analyzes them.
+ */
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <opencv2/opencv.hpp>
+
+#include "global.h"
+#include "SpscQueue.h"
+#include "FrameMailbox.h"
+#include "CaptureGeometry.h"
+#include "FrameSourceInterface.h"
+#include "StageProfiler.h"
+#include "HandDetector.h"
+#include "HandObservation.h"
+#include "SampleCollector.h"
+#include "GestureAnalystInterface.h"
+
+#ifndef PIPELINE_QUEUE_CAPACITY
+/**
+ * @brief PIPELINE_QUEUE_CAPACITY is the number of finished frames the queue from the inference stage to the owner thread can hold.
+ */
+#define PIPELINE_QUEUE_CAPACITY 4
+#endif
+#ifndef PIPELINE_IDLE_WAIT
+/**
+ * @brief PIPELINE_IDLE_WAIT is the time, in us, a pipeline stage sleeps before polling its input queue again.
+ */
+#define PIPELINE_IDLE_WAIT 200
+#endif
+
+/**
+ * @brief The FramePipeline class captures frames from the camera and analyzes them in three stages, each of which runs in its own thread.
+ *
+ * The stages are
+ *
+ *  - capture: reads a frame from a #FrameSourceInterface, e.g. the camera, and fits only its region of interesting to the tracking window via #CaptureGeometry ,
+ *  - detection: detects the hand via #HandDetector in the region of interesting and resizes the extracted hand image via #SampleCollector::resizeSample, and
+ *  - inference: recognizes the gesture via #GestureAnalystInterface::analyze , or those of all the hands detected via #GestureAnalystInterface::analyzeBatch in one pass.
+ *
+ * Stages are connected by lock-free mailboxes (#FrameMailbox) so that frame N+1 can be detected while frame N is in inference.
+ * Each mailbox keeps only the newest frame: under #FramePipeline::DROP_OLDEST a stage falling behind causes older frames to be dropped
+ * instead of being queued up, which bounds the latency between the camera and the result.
+ * Under #FramePipeline::NEVER_DROP the upstream stage waits for the downstream one instead.
+ * Finished frames are collected by the owner thread through #FramePipeline::takeFrame after #FramePipeline::frameProcessed is emitted.
+ *
+ * While detecting a live source, the pipeline goes into standby when no hand has been detected for #FramePipeline::setStandbyTimeout .
+ * During standby, frames are captured at #STANDBY_FPS and only passed to #HandDetector::checkPresence on a region of interesting
+ * shrunk by #STANDBY_PRESENCE_SCALE . The first frame where something is present leaves the standby and is detected as usual.
+ *
+ * **ATTENTION**:
+ *  While the pipeline is running, the #HandDetector lives in the detection thread.
+ *  Its slots connected by queued (or auto) connections are invoked between two frames.
+ *  Do not call its methods directly from other threads.
+ *
+ * @see #GestureControlSystem
+ */
+class FramePipeline : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief Frame is a captured frame and everything the pipeline obtained from it.
+     */
+    struct Frame
+    {
+        /**
+         * @brief id is the sequence number of the frame since the pipeline started. It starts from 1.
+         */
+        quint64 id;
+        /**
+         * @brief raw_frame is the frame as read from the camera.
+         */
+        cv::Mat raw_frame;
+        /**
+         * @brief geometry describes how #Frame::raw_frame is fitted to the tracking window.
+         *
+         * Call #CaptureGeometry::renderView with #Frame::raw_frame to obtain the whole tracking window.
+         */
+        std::shared_ptr<const CaptureGeometry> geometry;
+        /**
+         * @brief roi is the region of interesting on the tracking window used for detection.
+         */
+        cv::Rect roi;
+        /**
+         * @brief roi_img is the image of #Frame::roi on the tracking window, which is the input of #HandDetector::detect .
+         */
+        cv::Mat roi_img;
+        /**
+         * @brief examined indicates if the frame has been passed to #HandDetector::detect .
+         */
+        bool examined;
+        /**
+         * @brief presence_checked indicates if the frame has only been passed to #HandDetector::checkPresence during standby.
+         */
+        bool presence_checked;
+        /**
+         * @brief detected is the result of #HandDetector::detect .
+         */
+        bool detected;
+        /**
+         * @brief observation is what #HandDetector::observe gives, with #HandDetector::extractedImage after #SampleCollector::resizeSample as its hand image.
+         */
+        HandObservation observation;
+        /**
+         * @brief extra_observations are the hands found besides #Frame::observation , by decreasing area, if more than one hand is detected, see #HandDetector::setMaxHands .
+         */
+        std::vector<HandObservation> extra_observations;
+        /**
+         * @brief extracted_img is a copy of #HandDetector::extractedImage . It is only available when sampling or monitoring.
+         *
+         * @see #FramePipeline::setSampling
+         * @see #FramePipeline::setMonitoring
+         */
+        cv::Mat extracted_img;
+        /**
+         * @brief filtered_img is a copy of #HandDetector::filteredImage . It is only available when monitoring.
+         *
+         * @see #FramePipeline::setMonitoring
+         */
+        cv::Mat filtered_img;
+        /**
+         * @brief hand_contour is a copy of #HandDetector::handContour . It is only available when monitoring.
+         *
+         * It and #Frame::observation are what #HandDetector::drawConvexity needs, such that the image is only drawn by the monitor.
+         *
+         * @see #FramePipeline::setMonitoring
+         */
+        std::vector<cv::Point> hand_contour;
+        /**
+         * @brief analyzed indicates if #Frame::predictions is available.
+         */
+        bool analyzed;
+        /**
+         * @brief predictions is the result of #GestureAnalystInterface::analyze .
+         */
+        std::vector<GestureAnalystInterface::Prediction> predictions;
+        /**
+         * @brief extra_predictions are the results for each of #Frame::extra_observations , obtained in the same call of #GestureAnalystInterface::analyzeBatch .
+         */
+        std::vector<std::vector<GestureAnalystInterface::Prediction> > extra_predictions;
+
+        /**
+         * @brief read_us is the time, in us, spent in #FrameSourceInterface::read . It includes the time waiting for the frame.
+         */
+        qint64 read_us;
+        /**
+         * @brief geometry_us is the time, in us, spent fitting the region of interesting via #CaptureGeometry::extractRoi .
+         */
+        qint64 geometry_us;
+        /**
+         * @brief detection_us is the time, in us, spent in #HandDetector::detect and #SampleCollector::resizeSample .
+         */
+        qint64 detection_us;
+        /**
+         * @brief inference_us is the time, in us, spent in #GestureAnalystInterface::analyze , or #GestureAnalystInterface::analyzeBatch for several hands.
+         */
+        qint64 inference_us;
+
+        Frame() : id(0), examined(false), presence_checked(false), detected(false), analyzed(false),
+            read_us(0), geometry_us(0), detection_us(0), inference_us(0) {}
+    };
+
+    /**
+     * @brief DROP_POLICY represents what a stage does with its output when the next stage is still busy with the previous frame.
+     *
+     * @see #FramePipeline::setDropPolicy
+     */
+    enum DROP_POLICY
+    {
+        DROP_OLDEST, //!< replace the pending frame by the new one and count the pending one as dropped
+        NEVER_DROP   //!< wait until the next stage took the pending frame
+    };
+
+    explicit FramePipeline(HandDetector *hand_detector,
+                           SampleCollector *sample_collector,
+                           GestureAnalystInterface *gesture_analyst,
+                           QObject *parent = 0);
+    ~FramePipeline();
+
+    /**
+     * @brief start starts the stage threads.
+     *
+     * It does nothing if the pipeline is running already.
+     *
+     * @param source : an opened source from which frames are read.
+     *  If it is not live, no frame is dropped whatever #FramePipeline::setDropPolicy says.
+     */
+    void start(FrameSourceInterface *source);
+    /**
+     * @brief stop stops the stage threads and drops the frames in flight.
+     *
+     * It blocks until all stage threads finished.
+     */
+    void stop();
+    /**
+     * @brief isRunning returns if the pipeline is running.
+     */
+    bool isRunning() const;
+    /**
+     * @brief takeFrame takes a finished frame from the pipeline.
+     *
+     * It should be called by the owner thread until it returns `false` each time #FramePipeline::frameProcessed is received.
+     *
+     * @param frame : the place where the finished frame will be stored
+     * @retval true : if a finished frame was taken
+     * @retval false : if no finished frame is available
+     */
+    bool takeFrame(Frame &frame);
+
+    /**
+     * @brief setFrameGeometry sets the size to which captured frames are fitted.
+     * @param width : width of the tracking window
+     * @param height : height of the tracking window
+     */
+    void setFrameGeometry(const int &width, const int &height);
+    /**
+     * @brief setRoi sets the region of interesting used for detection.
+     * @param roi : the region of interesting on the fitted frame
+     */
+    void setRoi(const cv::Rect &roi);
+    /**
+     * @brief setDetecting sets if every frame is passed to the hand detector.
+     */
+    void setDetecting(const bool &detecting);
+    /**
+     * @brief setRecognizing sets if detected hands are passed to the gesture analyst.
+     */
+    void setRecognizing(const bool &recognizing);
+    /**
+     * @brief setSampling sets if the hand images of detected hands are copied into #Frame , to be collected as samples.
+     *
+     * @see #Frame::extracted_img
+     */
+    void setSampling(const bool &sampling);
+    /**
+     * @brief setMonitoring sets if the intermediate images of the hand detector are copied into #Frame .
+     *
+     * It also makes the hand detector run on every frame.
+     */
+    void setMonitoring(const bool &monitoring);
+    /**
+     * @brief setDropPolicy sets how the handoffs between capture, detection and inference deal with a busy downstream stage.
+     *
+     * The default policy is #FramePipeline::DROP_OLDEST .
+     */
+    void setDropPolicy(const DROP_POLICY &policy);
+    /**
+     * @brief droppedFrames returns the number of frames dropped since the pipeline started.
+     */
+    quint64 droppedFrames() const;
+    /**
+     * @brief setStageProfiler sets the profiler into which the stage threads record the latency of the stages they run.
+     *
+     * Call it only when the pipeline is not running.
+     *
+     * @param profiler : the profiler, or `nullptr` to record nothing
+     */
+    void setStageProfiler(StageProfiler *profiler);
+    /**
+     * @brief setStandbyTimeout sets the time without any hand detected after which the pipeline goes into standby.
+     *
+     * The standby is only used when the hand detector runs because of #FramePipeline::setDetecting , not for monitoring
+     * or setting the background image, and only for live sources.
+     *
+     * @param ms : the timeout in ms, or 0 to never go into standby
+     */
+    void setStandbyTimeout(const int &ms);
+    /**
+     * @brief isStandingBy returns if the pipeline is in standby.
+     */
+    bool isStandingBy() const;
+
+signals:
+    /**
+     * @brief frameProcessed is the signal to indicate that finished frames are available through #FramePipeline::takeFrame .
+     *
+     * It is emitted from the inference thread and is not emitted again before #FramePipeline::takeFrame returns `false`.
+     */
+    void frameProcessed();
+    /**
+     * @brief cameraFailed is the signal emitted from the capture thread when no frame can be read from the source.
+     *
+     * The capture thread exits after emitting it. Call #FramePipeline::stop to stop the other stages.
+     */
+    void cameraFailed();
+    /**
+     * @brief sourceFinished is the signal emitted from the capture thread when the source reached its end.
+     *
+     * The capture thread exits after emitting it, while the other stages keep finishing the frames in flight.
+     *
+     * @param frames : the number of frames read from the source, i.e. the #Frame::id of the last frame
+     */
+    void sourceFinished(const quint64 &frames);
+
+protected:
+    /**
+     * @brief _hand_detector is the #HandDetector used by the detection stage.
+     */
+    HandDetector *_hand_detector;
+    /**
+     * @brief _sample_collector is the #SampleCollector used to resize the extracted hand image.
+     */
+    SampleCollector *_sample_collector;
+    /**
+     * @brief _gesture_analyst is the #GestureAnalystInterface used by the inference stage.
+     */
+    GestureAnalystInterface *_gesture_analyst;
+    /**
+     * @brief _predictions_per_frame is the number of predictions obtained for each frame.
+     */
+    const int _predictions_per_frame = 5;
+
+private:
+    class Stage : public QThread
+    {
+    public:
+        explicit Stage(const std::function<void()> &loop) : _loop(loop) {}
+    protected:
+        void run() override { _loop(); }
+    private:
+        std::function<void()> _loop;
+    };
+
+    void _captureLoop();
+    void _detectionLoop();
+    void _inferenceLoop();
+    inline void _idle();
+    bool _handOver(FrameMailbox<Frame> &mailbox, Frame &frame);
+    inline void _profile(const StageProfiler::STAGE &stage, const qint64 &us);
+
+    FrameSourceInterface *_source;
+    StageProfiler *_stage_profiler;
+
+    Stage *_capture_stage;
+    Stage *_detection_stage;
+    Stage *_inference_stage;
+
+    FrameMailbox<Frame> _captured_frame;
+    FrameMailbox<Frame> _detected_frame;
+    SpscQueue<Frame> _processed_frames;
+
+    std::atomic<bool> _running;
+    std::atomic<bool> _stopping;
+    std::atomic<bool> _notified;
+    std::atomic<bool> _detecting;
+    std::atomic<bool> _recognizing;
+    std::atomic<bool> _sampling;
+    std::atomic<bool> _monitoring;
+    std::atomic<int> _drop_policy;
+    std::atomic<int> _standby_timeout;
+    std::atomic<bool> _standby;
+    bool _rate_lowered;
+
+    HandObservationPool _observation_pool;
+
+    QMutex _geometry_mutex;
+    int _frame_width;
+    int _frame_height;
+    cv::Rect _roi;
+};
+
+#endif // FRAMEPIPELINE_H
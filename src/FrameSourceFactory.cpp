@@ -0,0 +1,43 @@
+#include "FrameSourceFactory.h"
+
+#include "CameraSource.h"
+#include "ReplaySource.h"
+#include "SharedMemorySource.h"
+
+FrameSourceInterface *FrameSourceFactory::create(const QString &description, const size_t &camera_fps, const bool &realtime, const double &replay_fps)
+{
+    bool is_index;
+    auto index = description.toInt(&is_index);
+    if (is_index)
+        return new CameraSource(index, camera_fps);
+
+    const auto sep = description.indexOf(':');
+    // a single letter before the colon is a drive on Windows rather than a backend
+    const auto backend = sep > 1 ? description.left(sep) : QString();
+    const auto location = backend.isEmpty() ? description : description.mid(sep + 1);
+    if (location.isEmpty())
+        return nullptr;
+
+    if (backend.isEmpty())
+        return new ReplaySource(location, realtime, replay_fps);
+    if (backend == "camera")
+    {
+        index = location.toInt(&is_index);
+        return is_index ? new CameraSource(index, camera_fps) : nullptr;
+    }
+    if (backend == "shm")
+        return new SharedMemorySource(location);
+    if (backend == "video")
+        return new ReplaySource(location, ReplaySource::FORMAT_VIDEO, realtime, replay_fps);
+    if (backend == "dir")
+        return new ReplaySource(location, ReplaySource::FORMAT_IMAGE_DIRECTORY, realtime, replay_fps);
+    if (backend == "raw")
+        return new ReplaySource(location, ReplaySource::FORMAT_RAW_DUMP, realtime, replay_fps);
+    // an unknown backend may still be a path, e.g. a URL understood by OpenCV
+    return new ReplaySource(description, realtime, replay_fps);
+}
+
+QString FrameSourceFactory::usage()
+{
+    return "camera:<index>, shm:<name>, video:<file>, dir:<folder>, raw:<file> or a path";
+}
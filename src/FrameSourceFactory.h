@@ -0,0 +1,47 @@
+#ifndef FRAMESOURCEFACTORY_H
+#define FRAMESOURCEFACTORY_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The FrameSourceFactory.h file contains the factory who creates a frame source from its description.
+ */
+#include <QString>
+
+#include "global.h"
+#include "FrameSourceInterface.h"
+
+/**
+ * @brief The FrameSourceFactory class creates a #FrameSourceInterface from a description of the form `<backend>:<location>`.
+ *
+ * The backends are
+ *
+ *  - `camera:<index>`, or only the index: a camera opened via OpenCV, see #CameraSource ,
+ *  - `shm:<name>`: frames published by another process into a #SharedMemoryRing , see #SharedMemorySource ,
+ *  - `video:<path>`, `dir:<path>` or `raw:<path>`: a video file, a directory of images or a raw frame dump, see #ReplaySource .
+ *    A path without backend is replayed according to what it is, see #ReplaySource::formatOf .
+ */
+class FrameSourceFactory
+{
+public:
+    /**
+     * @brief create creates the frame source described.
+     * @param description : the description of the frame source
+     * @param camera_fps : the FPS requested from a camera
+     * @param realtime : if a recording is replayed at its recorded timing
+     * @param replay_fps : the FPS at which an image directory is replayed
+     * @return the frame source, or `nullptr` if the description is invalid. The caller takes the ownership.
+     */
+    static FrameSourceInterface *create(const QString &description,
+                                        const size_t &camera_fps = CAMERA_FPS,
+                                        const bool &realtime = true,
+                                        const double &replay_fps = CAMERA_FPS);
+    /**
+     * @brief usage returns a short description of the supported backends for the command line help.
+     */
+    static QString usage();
+
+private:
+    FrameSourceFactory() = delete;
+};
+
+#endif // FRAMESOURCEFACTORY_H
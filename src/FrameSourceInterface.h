@@ -0,0 +1,68 @@
+#ifndef FRAMESOURCEINTERFACE_H
+#define FRAMESOURCEINTERFACE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The FrameSourceInterface.h file contains the interface of the source from which #FramePipeline reads frames.
+ */
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief The FrameSourceInterface class provides an interface of the source from which #FramePipeline reads frames, e.g. a camera or a recording.
+ *
+ * **ATTENTION**:
+ *  #FrameSourceInterface::read and #FrameSourceInterface::setFrameRate are called from the capture thread of #FramePipeline,
+ *  while the other methods are called from the owner thread when the pipeline is not running.
+ */
+class FrameSourceInterface
+{
+public:
+    virtual ~FrameSourceInterface() {}
+
+    /**
+     * @brief open opens the source. It does nothing if the source is opened already.
+     * @retval true : if the source is opened
+     * @retval false : if the source cannot be opened
+     */
+    virtual bool open() = 0;
+    /**
+     * @brief isOpened returns if the source is opened.
+     */
+    virtual bool isOpened() const = 0;
+    /**
+     * @brief release closes the source.
+     */
+    virtual void release() = 0;
+    /**
+     * @brief read blocks until the next frame is available and reads it.
+     * @param frame : the place where the frame will be stored. Its buffer must not be reused by the source afterwards.
+     * @retval true : if a frame was read
+     * @retval false : if the source failed or reached its end
+     */
+    virtual bool read(cv::Mat &frame) = 0;
+    /**
+     * @brief atEnd returns if the source reached its end such that a failure of #FrameSourceInterface::read is not an error.
+     */
+    virtual bool atEnd() const = 0;
+    /**
+     * @brief isLive returns if the frames come from a live device.
+     *
+     * Frames of a source who is not live are never dropped by #FramePipeline, such that the output is deterministic.
+     */
+    virtual bool isLive() const = 0;
+    /**
+     * @brief frameSize returns the size of the frames. It is only available after the source is opened.
+     */
+    virtual cv::Size frameSize() const = 0;
+    /**
+     * @brief setFrameRate asks the source to deliver frames at another rate, e.g. to save power during standby.
+     *
+     * The default implementation does nothing. #FramePipeline then skips frames by itself.
+     *
+     * @param fps : the requested FPS, or 0 to restore the FPS at which the source was opened
+     * @return if the source changed its rate
+     */
+    virtual bool setFrameRate(const double &/* fps */) { return false; }
+};
+
+#endif // FRAMESOURCEINTERFACE_H
@@ -7,6 +7,31 @@ GestureAnalyst::GestureAnalyst()
 }
 
 int GestureAnalyst::load(const QString &model_file)
+{
+    QMutexLocker locker(&_mutex);
+    if (!_buildNetwork())
+        return -1;
+    _net->CopyTrainedLayersFrom(model_file.toStdString());
+    if (_net->num_inputs() != 1)
+        //        return ERROR_INPUT_LAYER_NUM;
+        return -1;
+    if (_net->num_outputs() != 1)
+        //        return ERROR_OUTPUT_LAYER_NUM;
+        return -2;
+    caffe::Blob<float> * input_layer = _net->input_blobs()[0];
+    if (input_layer->channels() != _num_of_channels)
+        //        return ERROR_IMAGE_CHANNEL;
+        return -3;
+
+    _input_geometry = cv::Size(input_layer->width(), input_layer->height());
+    if (_input_geometry.width != SAMPLE_SIZE_WIDTH || _input_geometry.height != SAMPLE_SIZE_HEIGHT)
+        //        return ERROR_IMAGE_SIZE;
+        return -4;
+
+    return _net->output_blobs()[0]->channels();
+}
+
+bool GestureAnalyst::_buildNetwork()
 {
     caffe::NetParameter param;
 
@@ -16,7 +41,7 @@ int GestureAnalyst::load(const QString &model_file)
     auto a = QTemporaryFile::createNativeFile(file);
 
     if (!a->open())
-        return -1;
+        return false;
     int fd = a->handle();
 
     google::protobuf::io::FileInputStream* input = new google::protobuf::io::FileInputStream(fd);
@@ -33,36 +58,64 @@ int GestureAnalyst::load(const QString &model_file)
 
 //    _net.reset(new caffe::Net<float>(network_file, caffe::TEST));
     _net.reset(new caffe::Net<float>(param));
-    _net->CopyTrainedLayersFrom(model_file.toStdString());
-    if (_net->num_inputs() != 1)
-        //        return ERROR_INPUT_LAYER_NUM;
-        return -1;
-    if (_net->num_outputs() != 1)
-        //        return ERROR_OUTPUT_LAYER_NUM;
-        return -2;
-    caffe::Blob<float> * input_layer = _net->input_blobs()[0];
-    if (input_layer->channels() != _num_of_channels)
-        //        return ERROR_IMAGE_CHANNEL;
-        return -3;
-
-    _input_geometry = cv::Size(input_layer->width(), input_layer->height());
-    if (_input_geometry.width != SAMPLE_SIZE_WIDTH || _input_geometry.height != SAMPLE_SIZE_HEIGHT)
-        //        return ERROR_IMAGE_SIZE;
-        return -4;
-
-    return _net->output_blobs()[0]->channels();
+    return true;
 }
 
 std::vector<GestureAnalyst::Prediction> GestureAnalyst::analyze(const cv::Mat &img, const int &get_N)
 {
+    auto res = analyzeBatch(std::vector<cv::Mat>(1, img), get_N);
+    return res.empty() ? std::vector<Prediction>() : res[0];
+}
+
+std::vector<std::vector<GestureAnalyst::Prediction> > GestureAnalyst::analyzeBatch(const std::vector<cv::Mat> &imgs, const int &get_N)
+{
+    QMutexLocker locker(&_mutex);
+    if (!_net || imgs.empty())
+        return std::vector<std::vector<Prediction> >();
+    // caffe keeps its work mode per thread
+    caffe::Caffe::set_mode(caffe::Caffe::CAFFE_WORK_MODE);
     // Refresh input layer
-    _net->input_blobs()[0]->Reshape(1, _num_of_channels, _input_geometry.height, _input_geometry.width);
+    const int batch_size = static_cast<int>(imgs.size());
+    _net->input_blobs()[0]->Reshape(batch_size, _num_of_channels, _input_geometry.height, _input_geometry.width);
     _net->Reshape();
+    for (int i = 0; i < batch_size; ++i)
+        _setInput(imgs[i], i);
+
+    // run the network
+    float loss;
+    _net->Forward(&loss);
+
+    // pick up the output results
+    caffe::Blob<float> * output_layer = _net->output_blobs()[0];
+    const int num_labels = output_layer->channels();
+    const int N = get_N < num_labels ? get_N : num_labels;
+    std::vector<std::vector<Prediction> > res(batch_size);
+    for (int b = 0; b < batch_size; ++b)
+    {
+        const float * output = output_layer->cpu_data() + output_layer->offset(b);
+        std::vector<Prediction> prob;
+        for (int i = num_labels; --i > -1;)
+            prob.push_back(Prediction(i, *(output+i)));
+
+        // get the best N results
+        std::partial_sort(prob.begin(), prob.begin()+N, prob.end(),
+                          [](const Prediction &lhs,
+                          const Prediction &rhs) -> bool
+        {
+            return lhs.prob > rhs.prob;
+        });
+        res[b].assign(prob.begin(), prob.begin()+N);
+    }
+    return res;
+}
+
+void GestureAnalyst::_setInput(const cv::Mat &img, const int &index)
+{
     // Map each input at the input layer to a cv::Mat variable, input_channels,
     // so that we can give input by directly modifying the Mat variable
     std::vector<cv::Mat> input_channels;
     caffe::Blob<float> * input_layer = _net->input_blobs()[0];
-    float * data = input_layer->mutable_cpu_data();
+    float * data = input_layer->mutable_cpu_data() + input_layer->offset(index);
     for (int i = 0; i < input_layer->channels(); ++i)
     {
         cv::Mat channel(input_layer->height(), input_layer->width(), CV_32FC1, data);
@@ -105,27 +158,4 @@ std::vector<GestureAnalyst::Prediction> GestureAnalyst::analyze(const cv::Mat &i
 
     // write data to the input channels mapped to the input layer already
     cv::split(tar, input_channels);
-
-    // run the network
-    float loss;
-    _net->Forward(&loss);
-
-    // pick up the output results
-    caffe::Blob<float> * output_layer = _net->output_blobs()[0];
-    std::vector<Prediction> prob;
-    for (int i = output_layer->channels(); --i > -1;)
-        prob.push_back(Prediction(i, *(output_layer->cpu_data()+i)));
-
-    // get the best N results
-    std::partial_sort(prob.begin(), prob.begin()+(get_N<prob.size()?get_N:prob.size()), prob.end(),
-                      [](const Prediction &lhs,
-                      const Prediction &rhs) -> bool
-    {
-        return lhs.prob > rhs.prob;
-    });
-    std::vector<Prediction> max_N;
-    for (int i = 0; i < get_N; ++i)
-        max_N.push_back(prob[i]);
-
-    return max_N;
 }
@@ -17,10 +17,13 @@
 #include <google/protobuf/text_format.h>
 #include <QFile>
 #include <QTemporaryFile>
+#include <QMutex>
 #include <QDebug>
 
 /**
  * @brief The GestureAnalyst class is an implementation of the gesture analyst based on CNN and MNIST network structure.
+ *
+ * #GestureAnalyst::load and #GestureAnalyst::analyze are serialized by a mutex such that a model can be loaded from the GUI thread while the inference thread of #FramePipeline is analyzing.
  */
 class GestureAnalyst : public GestureAnalystInterface
 {
@@ -41,6 +44,13 @@ public:
      * @return N best prediction results where N is defined by the argument `get_N`
      */
     std::vector<Prediction> analyze(const cv::Mat &img, const int &get_N);
+    /**
+     * @brief analyzeBatch recognizes gestures from all the given images in one forward pass of the network.
+     * @param imgs : sample images containing hand/gesture
+     * @param get_N : the number of prediction results that will be returned for each image
+     * @return N best prediction results for each image, in the order of the images, or nothing if no model is loaded
+     */
+    std::vector<std::vector<Prediction> > analyzeBatch(const std::vector<cv::Mat> &imgs, const int &get_N) override;
 
 protected:
     /**
@@ -56,6 +66,19 @@ protected:
      */
     const int _num_of_channels = 1;
 
+    /**
+     * @brief _buildNetwork creates #GestureAnalyst::_net from the network structure shipped as the resource `:/lenet.prototxt`, without any trained weights.
+     * @return if the network structure is parsed
+     */
+    bool _buildNetwork();
+    /**
+     * @brief _setInput converts the given image into the format of the input layer and writes it as the `index`-th image of the input blob.
+     */
+    void _setInput(const cv::Mat &img, const int &index);
+
+private:
+    QMutex _mutex;
+
 };
 
 #endif // GESTUREANALYST_H
@@ -46,6 +46,24 @@ public:
      * @return N best prediction results where N is defined by the argument `get_N`
      */
     virtual std::vector<Prediction> analyze(const cv::Mat &img, const int& get_N=1) = 0;
+    /**
+     * @brief analyzeBatch recognizes gestures from each of the given images.
+     *
+     * The default implementation calls #GestureAnalystInterface::analyze for each image.
+     * An analyst who can process several images in one pass should override it.
+     *
+     * @param imgs : sample images containing hand/gesture
+     * @param get_N : the number of prediction results that will be returned for each image
+     * @return N best prediction results for each image, in the order of the images
+     */
+    virtual std::vector<std::vector<Prediction> > analyzeBatch(const std::vector<cv::Mat> &imgs, const int &get_N=1)
+    {
+        std::vector<std::vector<Prediction> > res;
+        res.reserve(imgs.size());
+        for (const auto &img : imgs)
+            res.push_back(analyze(img, get_N));
+        return res;
+    }
 
 };
 Q_DECLARE_INTERFACE(GestureAnalystInterface,"PeiXu.GestureAnalystInterface/1.0")
@@ -1,23 +1,11 @@
 #include "GestureControlSystem.h"
 
 GestureControlSystem::GestureControlSystem(HandDetector *hand_detector, SampleCollector *sample_collector, GestureAnalystInterface *gesture_analyst, CommandInputterInterface *command_inputter, QObject *parent) :
-    QObject(parent),
+    GestureEngine(hand_detector, sample_collector, gesture_analyst, command_inputter, parent),
     main_view(MainView::getInstance()),
     tracking_view(TrackingView::getInstance()),
     setting_view(SettingView::getInstance()),
-    monitor_view(MonitorView::getInstance()),
-    camera_fps(_camera_fps),
-    work_status(_work_status),
-    roi(_roi),
-    cursor_roi(_cursor_roi),
-    _hand_detector(hand_detector),
-    _sample_collector(sample_collector),
-    _gesture_analyst(gesture_analyst),
-    _command_inputter(command_inputter),
-    _work_status(STATUS_IDLE),
-    _camera_capture_timer(new QTimer),
-    _settings(Settings::getInstance()),
-    _camera(new cv::VideoCapture)
+    monitor_view(MonitorView::getInstance())
 {
     connect(main_view, SIGNAL(mainViewClosing()), this, SLOT(windowClosing()));
     connect(main_view, SIGNAL(settingWindowRequest()), this, SLOT(openSettingWindow()));
@@ -38,15 +26,18 @@ GestureControlSystem::GestureControlSystem(HandDetector *hand_detector, SampleCo
     connect(setting_view, SIGNAL(changeRoiRange(int,int,int,int)), this, SLOT(verifyRoiRange(int,int,int,int)));
     connect(setting_view, SIGNAL(changeDetectionArea(int)), _hand_detector, SLOT(setDetectionArea(int)));
     connect(setting_view, SIGNAL(changeMorphology(bool)), _hand_detector, SLOT(setMorphology(bool)));
+    connect(setting_view, SIGNAL(changeBackgroundLearningRate(double)), _hand_detector, SLOT(setBackgroundLearningRate(double)));
     connect(setting_view, SIGNAL(backgroundSettingRequest()), _hand_detector, SLOT(setBackgroundImage()));
     connect(setting_view, SIGNAL(backgroundClearingRequest()), _hand_detector, SLOT(clearBackgroundImage()));
     connect(setting_view, SIGNAL(changeLabelList()), tracking_view, SLOT(reloadLabelList()));
 
-    connect(_hand_detector, SIGNAL(backgroundImageSet()), this, SLOT(updateBackgroundImage()));
+    connect(_hand_detector, SIGNAL(backgroundImageSet(cv::Mat)), this, SLOT(updateBackgroundImage(cv::Mat)));
     connect(_hand_detector, SIGNAL(backgroundImageCleared()), setting_view, SLOT(clearBackgroundImage()));
 
     connect(_command_inputter, SIGNAL(commandMade(QString)), this, SLOT(informActionMade(QString)));
 
+    connect(monitor_view, SIGNAL(latencyDumpRequest(QString)), this, SLOT(dumpLatency(QString)));
+
     connect(this, SIGNAL(cameraOpened()), tracking_view, SLOT(cameraStarted()));
     connect(this, SIGNAL(cameraOpened()), setting_view, SLOT(enableBackgroundSetting()));
     connect(this, SIGNAL(cameraReleased()), tracking_view, SLOT(cameraReleased()));
@@ -61,8 +52,9 @@ GestureControlSystem::GestureControlSystem(HandDetector *hand_detector, SampleCo
     connect(this, SIGNAL(controllingTaskStopped()), tracking_view, SLOT(controllingTaskStopped()));
     connect(this, SIGNAL(controllingTaskStopped()), main_view, SLOT(changeWorkStatusToNothing()));
 
-    connect(_camera_capture_timer, SIGNAL(timeout()), this, SLOT(captureFrame()));
-
+    // not on the setting window; the setting file decides
+    _hand_detector->setPyramidScale(_settings->detection_pyramid_scale);
+    _hand_detector->setMaxHands(_settings->detection_max_hands);
     setting_view->setToCurrentSettings();
 }
 
@@ -101,41 +93,21 @@ void GestureControlSystem::openSettingWindowGestureList()
 
 void GestureControlSystem::openMonitorWindow()
 {
+    _pipeline->setMonitoring(true);
     monitor_view->show();
     monitor_view->raise();
 }
 
 void GestureControlSystem::verifyRoiRange(const int &start_x, const int &end_x, const int &start_y, const int &end_y)
 {
-    _roi.x = tracking_view->getVideoFrameWidth() * start_x/100;
-    _roi.y = tracking_view->getVideoFrameHeight() * start_y/100;
-    _roi.width = tracking_view->getVideoFrameWidth() * (end_x-start_x)/100;
-    _roi.height = tracking_view->getVideoFrameHeight() * (end_y-start_y)/100;
-
-    if (_roi.width < DEFAULT_ROI_MARGIN_LEFT + DEFAULT_ROI_MARGIN_RIGHT + 1)
-    {
-        _roi.width = DEFAULT_ROI_MARGIN_LEFT + DEFAULT_ROI_MARGIN_RIGHT + 1;
-        if (_roi.x + _roi.width > tracking_view->getVideoFrameWidth())
-            _roi.x = tracking_view->getVideoFrameWidth() - _roi.width;
-    }
-    if (_roi.height < DEFAULT_ROI_MARGIN_TOP + DEFAULT_ROI_MARGIN_BOTTOM + 1)
-    {
-        _roi.height = DEFAULT_ROI_MARGIN_TOP + DEFAULT_ROI_MARGIN_BOTTOM + 1;
-        if (_roi.y + _roi.height > tracking_view->getVideoFrameHeight())
-            _roi.y = tracking_view->getVideoFrameHeight() - _roi.height;
-    }
-    _cursor_roi.x = _roi.x + DEFAULT_ROI_MARGIN_LEFT;
-    _cursor_roi.y = _roi.y + DEFAULT_ROI_MARGIN_TOP;
-    _cursor_roi.width = _roi.width - DEFAULT_ROI_MARGIN_LEFT - DEFAULT_ROI_MARGIN_RIGHT;
-    _cursor_roi.height= _roi.height- DEFAULT_ROI_MARGIN_TOP - DEFAULT_ROI_MARGIN_BOTTOM;
+    setFrameGeometry(tracking_view->getVideoFrameWidth(), tracking_view->getVideoFrameHeight());
+    setRoiRange(start_x, end_x, start_y, end_y);
 }
 
-void GestureControlSystem::updateBackgroundImage()
+void GestureControlSystem::updateBackgroundImage(const cv::Mat &background)
 {
     setting_view->setBackgroundImage(
-                ImgConvertor::cvMat2QPixmap(
-                    this->_hand_detector->background_img
-                    )
+                ImgConvertor::cvMat2QPixmap(background)
                 );
 }
 
@@ -144,61 +116,28 @@ void GestureControlSystem::informActionMade(const QString &action)
     tracking_view->appendText(action);
 }
 
-void GestureControlSystem::openCamera()
-{
-    if (!_camera->isOpened())
-    {
-        _camera->open(0);
-        if (!_camera->isOpened())
-        {
-            _handleCameraError();
-            return;
-        }
-    }
-    emit cameraOpened();
-    _camera_capture_timer->start(1000/_camera_fps);
-}
-
-void GestureControlSystem::releaseCamera()
+void GestureControlSystem::dumpLatency(const QString &file)
 {
-    _camera_capture_timer->stop();
-    // FIXME exception caused by opencv when releasing the camera
-    //    if (_camera->isOpened())
-    //        _camera->release();
+    if (!_stage_profiler.writeCsv(file))
+        QMessageBox::critical(monitor_view, tr("Error"),
+                              QString(tr("<div style=\"font-weight:100\">"
+                                         "Failed to write the latency into<pre style=\"padding-left:10px\">%1</pre>"
+                                         "</div>")).arg(file.toHtmlEscaped())
+                              );
 }
 
-void GestureControlSystem::captureFrame()
+bool GestureControlSystem::openCamera()
 {
-    if (_camera->isOpened())
-    {
-        cv::Mat captured_frame;
-        _camera->read(captured_frame);
-        if (!captured_frame.empty())
-        {
-            // resize and keep aspect ratio
-            cv::resize(captured_frame, captured_frame,
-                       cv::Size(captured_frame.cols*tracking_view->getVideoFrameHeight()/captured_frame.rows,
-                                tracking_view->getVideoFrameHeight()));
-            captured_frame(
-                        cv::Rect(
-                            (captured_frame.cols - tracking_view->getVideoFrameWidth())/2, 0,
-                            tracking_view->getVideoFrameWidth(), tracking_view->getVideoFrameHeight()
-                            )
-                        ).copyTo(captured_frame);
-            cv::flip(captured_frame, captured_frame, 1);
-
-            _processCapturedFrame(captured_frame);
-            return;
-        }
-    }
-    _handleCameraError();
+    setFrameGeometry(tracking_view->getVideoFrameWidth(), tracking_view->getVideoFrameHeight());
+    _pipeline->setMonitoring(monitor_view->isVisible());
+    return GestureEngine::openCamera();
 }
 
 void GestureControlSystem::startSamplingTask(const int &label_index, const QString &folder_path)
 {
     if (_work_status == STATUS_CONTROLLING)
         stopControllingTask();
-    if (!_camera->isOpened())
+    if (!isCameraOpened())
     {
         _handleCameraError();
         return;
@@ -225,11 +164,11 @@ void GestureControlSystem::startSamplingTask(const int &label_index, const QStri
                                   _sample_collector->storage_path.toHtmlEscaped()),
                     QMessageBox::Cancel, QMessageBox::Ok))
         {
-            _work_status = STATUS_SAMPLING;
             _sampling_trails = 0;
             _samples_collected = 0;
             _settings->setSampleStoragePath(folder_path);
             _settings->setSelectedGesture(label_index);
+            _setWorkStatus(STATUS_SAMPLING);
             emit samplingTaskStarted();
         }
         else
@@ -244,41 +183,16 @@ void GestureControlSystem::stopSamplingTask()
     _samplingCompleted();
 }
 
-void GestureControlSystem::startControllingTask(const QString &model_file, const QString &keymap_file)
+bool GestureControlSystem::startControllingTask(const QString &model_file, const QString &keymap_file)
 {
     if (_work_status == STATUS_SAMPLING)
         stopSamplingTask();
-    if (_command_inputter->load(keymap_file))
-    {
-        if (_command_inputter->labels().empty())
-        {
-            _handleControllingError(CONTROLLING_ERROR_ILLEGAL_KEYMAP_FILE);
-            return;
-        }
-        int num_labels = _gesture_analyst->load(model_file);
-
-        if (num_labels == _command_inputter->labels().size())
-        {
-            _work_status = STATUS_CONTROLLING;
-            _settings->setCnnModelFile(model_file);
-            _settings->setKeymapFile(keymap_file);
-            emit controllingTaskStarted();
-            return;
-        }
-        _handleControllingError(CONTROLLING_ERROR_INVALID_KEYMAP_FILE);
-        return;
-    }
-    _handleControllingError(CONTROLLING_ERROR_ILLEGAL_KEYMAP_FILE);
-}
-
-void GestureControlSystem::stopControllingTask()
-{
-    _work_status = STATUS_IDLE;
-    emit controllingTaskStopped();
+    return GestureEngine::startControllingTask(model_file, keymap_file);
 }
 
 void GestureControlSystem::windowClosing()
 {
+    _pipeline->stop();
     tracking_view->close();
     monitor_view->close();
     setting_view->close();
@@ -286,28 +200,23 @@ void GestureControlSystem::windowClosing()
 
 void GestureControlSystem::_handleCameraError()
 {
-    _camera_capture_timer->stop();
-    emit cameraReleased();
+    GestureEngine::_handleCameraError();
     QMessageBox::critical(main_view, tr("Error"), tr("Failed to open camera."));
 }
 
-void GestureControlSystem::_processCapturedFrame(cv::Mat &captured_frame)
+void GestureControlSystem::_processCapturedFrame(FramePipeline::Frame &frame)
 {
-    bool detected = false;
-    if (monitor_view->isVisible() || _hand_detector->waitting_bg || _work_status == STATUS_CONTROLLING || _work_status == STATUS_SAMPLING)
+    if (frame.examined)
     {
-        detected = _hand_detector->detect(captured_frame(_roi));
-
-        if (detected)
+        if (frame.detected)
         {
             if (_work_status == STATUS_CONTROLLING)
-            {
-                _recognize(_sample_collector->resizeSample(_hand_detector->extracted_img), _hand_detector->tracked_point);
-            }
+                GestureEngine::_processCapturedFrame(frame);
             else
             {
-                if (_work_status == STATUS_SAMPLING && !_sample_collector->deny())
-                    _sample(_hand_detector->extracted_img);
+                // a frame detected before sampling started carries no hand image, and is skipped rather than failing the sampling
+                if (_work_status == STATUS_SAMPLING && !_sample_collector->deny() && !frame.extracted_img.empty())
+                    _sample(frame.extracted_img);
             }
         }
         else
@@ -319,35 +228,65 @@ void GestureControlSystem::_processCapturedFrame(cv::Mat &captured_frame)
 
             }
         }
-        if (monitor_view->isVisible())
+        if (monitor_view->isVisible() && !frame.filtered_img.empty())
         {
-            if (_hand_detector->extracted_img.empty())
+            QElapsedTimer timer;
+            timer.start();
+            cv::Mat convexity_img;
+            HandDetector::drawConvexity(convexity_img, frame.filtered_img.size(),
+                                        frame.hand_contour, frame.observation);
+            if (!frame.observation.crop)
                 monitor_view->updateMonitorImage2(
-                            ImgConvertor::cvMat2QPixmap(_hand_detector->filtered_img),
-                            ImgConvertor::cvMat2QPixmap(_hand_detector->convexity_img)
+                            ImgConvertor::cvMat2QPixmap(frame.filtered_img),
+                            ImgConvertor::cvMat2QPixmap(convexity_img)
                             );
             else
                 monitor_view->updateMonitorImage3(
-                            // ImgConvertor::cvMat2QPixmap(_hand_detector->interesting_img),
-                            ImgConvertor::cvMat2QPixmap(_hand_detector->filtered_img),
-//                            ImgConvertor::cvMat2QPixmap(_hand_detector->extracted_img),
-                            ImgConvertor::cvMat2QPixmap(_sample_collector->resizeSample(_hand_detector->extracted_img)),
-                            ImgConvertor::cvMat2QPixmap(_hand_detector->convexity_img)
+                            ImgConvertor::cvMat2QPixmap(frame.filtered_img),
+                            ImgConvertor::cvMat2QPixmap(*frame.observation.crop),
+                            ImgConvertor::cvMat2QPixmap(convexity_img)
                             );
+            _stage_profiler.record(StageProfiler::STAGE_PIXMAP, timer.nsecsElapsed()/1000);
         }
 
     }
-    if (tracking_view->isVisible())
+}
+
+void GestureControlSystem::_processNewestFrame(const FramePipeline::Frame &frame)
+{
+    // the tracking window only shows the newest frame at display rate
+    if (tracking_view->isVisible() &&
+            (!_preview_timer.isValid() || _preview_timer.elapsed() >= 1000/PREVIEW_FPS))
+    {
+        _preview_timer.start();
+        _updateTrackingView(frame);
+    }
+    if (monitor_view->isVisible() &&
+            (!_latency_timer.isValid() || _latency_timer.elapsed() >= LATENCY_REFRESH_INTERVAL))
     {
-        cv::rectangle(captured_frame, _roi, HandDetector::COLOR_GREEN, 2);
-        if (tracking_view->work_mode == TrackingView::MODE_CONTROLLING)
-        {
-            cv::rectangle(captured_frame, _cursor_roi, HandDetector::COLOR_RED, 3);
-            if (detected)
-                cv::circle(captured_frame(_roi), _hand_detector->tracked_point, 3, HandDetector::COLOR_BLUE, -1);
-        }
-        tracking_view->updateVideoFrame(ImgConvertor::cvMat2QPixmap(captured_frame));
+        _latency_timer.start();
+        monitor_view->updateLatency(_stage_profiler);
     }
+    _pipeline->setFrameGeometry(tracking_view->getVideoFrameWidth(), tracking_view->getVideoFrameHeight());
+    _pipeline->setMonitoring(monitor_view->isVisible());
+}
+
+void GestureControlSystem::_updateTrackingView(const FramePipeline::Frame &frame)
+{
+    cv::Mat view;
+    frame.geometry->renderView(frame.raw_frame, view);
+    cv::rectangle(view, frame.roi, HandDetector::COLOR_GREEN, 2);
+    if (tracking_view->work_mode == TrackingView::MODE_CONTROLLING)
+    {
+        cv::rectangle(view, cursor_roi, HandDetector::COLOR_RED, 3);
+        if (frame.detected)
+            cv::circle(view(frame.roi), frame.observation.tracked_point, 3, HandDetector::COLOR_BLUE, -1);
+    }
+    QElapsedTimer timer;
+    timer.start();
+    auto pixmap = ImgConvertor::cvMat2QPixmap(view);
+    _stage_profiler.record(StageProfiler::STAGE_PIXMAP, timer.nsecsElapsed()/1000);
+    tracking_view->updateVideoFrame(pixmap);
 }
 
 void GestureControlSystem::_sample(const cv::Mat &image)
@@ -387,7 +326,7 @@ void GestureControlSystem::_handleSamplingError(const SAMPLING_ERROR &e)
 
 void GestureControlSystem::_samplingCompleted()
 {
-    _work_status = STATUS_IDLE;
+    _setWorkStatus(STATUS_IDLE);
     emit samplingTaskStopped();
     tracking_view->appendText(QString(tr("[Info] Sampling Completed.\n"
                                          "[Info] %1 Samples were stored at\n%2\n"
@@ -404,13 +343,9 @@ void GestureControlSystem::_samplingCompleted()
                              );
 }
 
-void GestureControlSystem::_recognize(const cv::Mat &image, const cv::Point &tracked_point)
+void GestureControlSystem::_recognize(const std::vector<GestureAnalystInterface::Prediction> &res, const cv::Point &tracked_point)
 {
-    auto res = _gesture_analyst->analyze(image, 5);
-
-    _command_inputter->input(res[0].label_id,
-            static_cast<float>(tracked_point.x-DEFAULT_ROI_MARGIN_LEFT)/_cursor_roi.width,
-            static_cast<float>(tracked_point.y-DEFAULT_ROI_MARGIN_TOP)/_cursor_roi.height);
+    GestureEngine::_recognize(res, tracked_point);
     QStringList msg;
     for (const auto &p : res)
     {
@@ -6,38 +6,27 @@
  * @brief The GestureControlSystem.h file contains the class who is the controller of the whole system.
  */
 #include <QObject>
-#include <QTimer>
 #include <QString>
+#include <QElapsedTimer>
 #include <opencv2/opencv.hpp>
 
 #include "global.h"
+#include "GestureEngine.h"
 #include "MainView.h"
 #include "SettingView.h"
 #include "TrackingView.h"
 #include "MonitorView.h"
-#include "Settings.h"
-#include "HandDetector.h"
-#include "SampleCollector.h"
-#include "GestureAnalystInterface.h"
-#include "CommandInputterInterface.h"
 
 /**
  * @brief The GestureControlSystem class is the controller of the whole system.
+ *
+ * It extends #GestureEngine, which captures and analyzes frames by a #FramePipeline in worker threads, with the windows and sampling.
+ * This class only handles the finished frames in the GUI thread.
  */
-class GestureControlSystem : public QObject
+class GestureControlSystem : public GestureEngine
 {
     Q_OBJECT
 public:
-    /**
-     * @brief WORK_STATUS represents the current work status of the system.
-     */
-    enum WORK_STATUS
-    {
-        STATUS_IDLE,         //!< idle
-        STATUS_CONTROLLING,  //!< controlling
-        STATUS_SAMPLING,     //!< sampling
-    };
-
     /**
      * @brief SAMPLING_ERROR represents the error appearing during samples.
      *
@@ -51,17 +40,6 @@ public:
         SAMPLING_ERROR_STORAGE_IMAGE  //!< failed to store sample images at the given path
     };
 
-    /**
-     * @brief The CONTROLLING_ERROR represents the error appearing during controlling.
-     *
-     * @see #GestureControlSystem::_handleControllingError
-     */
-    enum CONTROLLING_ERROR
-    {
-        CONTROLLING_ERROR_ILLEGAL_KEYMAP_FILE, //!< illegal or invalid keymap file
-        CONTROLLING_ERROR_INVALID_KEYMAP_FILE  //!< the model file is unmatched with the provide network structure
-    };
-
     /**
      * @brief main_view is the GUI of the main window.
      *
@@ -86,24 +64,6 @@ public:
      * @see #MonitorView
      */
     MonitorView *monitor_view;
-    /**
-     * @brief camera_fps is the FPS of the camera.
-     */
-    const size_t &camera_fps;
-    /**
-     * @brief work_status is the current work status. This is a reference to #GestureControlSystem::_work_status.
-     *
-     * @see #GestureControlSystem::WORK_STATUS
-     */
-    const WORK_STATUS &work_status;
-    /**
-     * @brief _roi is the region of interesting on the frame captured by the camera.
-     */
-    const cv::Rect &roi;
-    /**
-     * @brief _cursor_roi is a modified ROI in the interior of _ROI to mapping cursor position from tracked point estimated by HandDetector.
-     */
-    const cv::Rect &cursor_roi;
 
     explicit GestureControlSystem(HandDetector *hand_detector,
                                   SampleCollector *sample_collector,
@@ -117,28 +77,11 @@ public:
 
 signals:
     /**
-     * @brief cameraOpened is the signal emitted right after the camera launched.
-     */
-    void cameraOpened();
-    /**
-     * @brief cameraReleased is the signal emitted right after the camera is released.
-     */
-    void cameraReleased();
-
-    /**
-     * @brief controllingTaskStarted is the signal to indicate the start of controlling task.
-     */
-    void controllingTaskStarted();
-    /**
-     * @brief controllingTaskStopped is the signal to indicate the stop of controlling task.
-     */
-    void controllingTaskStopped();
-    /**
-     * @brief controllingTaskStarted is the signal to indicate the start of sampling task.
+     * @brief samplingTaskStarted is the signal to indicate the start of sampling task.
      */
     void samplingTaskStarted();
     /**
-     * @brief controllingTaskStarted is the signal to indicate the stop of sampling task.
+     * @brief samplingTaskStopped is the signal to indicate the stop of sampling task.
      */
     void samplingTaskStopped();
 
@@ -164,42 +107,41 @@ public slots:
      */
     void openMonitorWindow();
     /**
-     * @brief verifyRoiRange verifies the given ROI range and stores the verified range.
+     * @brief verifyRoiRange verifies the given ROI range on the tracking window and stores the verified range.
      *
      * @param start_x : the left bound of the ROI in percent
      * @param end_x : the right bound of the ROI in percent
      * @param start_y : the top bound of the ROI in percent
      * @param end_y : the bottom bound of the ROI in percent
+     *
+     * @see #GestureEngine::setRoiRange
      */
     void verifyRoiRange(const int &start_x, const int &end_x, const int &start_y, const int &end_y);
     /**
      * @brief updateBackgroundImage updates the background image shown in the setting window.
+     * @param background : the background image sent by #HandDetector::backgroundImageSet
      */
-    void updateBackgroundImage();
+    void updateBackgroundImage(const cv::Mat &background);
     /**
      * @brief informActionMade informs what action made by the control system.
      * @param action : name of the action made
      */
     void informActionMade(const QString &action);
     /**
-     * @brief openCamera opens the camera and shows error message if the camera cannot be open.
-     * @see #GestureControlSystem::_handleCameraError
-     */
-    void openCamera();
-    /**
-     * @brief releaseCamera closes the camera.
+     * @brief dumpLatency writes the latency of each stage into a CSV file and shows error message if it fails.
+     * @param file : path of the CSV file
      *
-     * **ATTENTION**:
-     *   This function cannot work properly on Mac OS (at least at Mac OS 10.12.3) due to the exception caused by opencv when releasing the camera on MAC OS
+     * @see #StageProfiler::writeCsv
      */
-    void releaseCamera();
+    void dumpLatency(const QString &file);
     /**
-     * @brief captureFrame captures frame from the camera and analyzes the captured frame. It will show an error message if it failed to capture frame from the camera.
+     * @brief openCamera opens the camera and shows error message if the camera cannot be open.
+     *
+     * Captured frames are fitted to the tracking window.
      *
-     * @see #GestureControlSystem::_processCapturedFrame
      * @see #GestureControlSystem::_handleCameraError
      */
-    void captureFrame();
+    bool openCamera() override;
     /**
      * @brief startSamplingTask starts a sampling task.
      *
@@ -222,18 +164,13 @@ public slots:
     /**
      * @brief startControllingTask starts a controlling task.
      *
-     * It sets #GestureControlSystem::_work_status and emits the signal of #GestureControlSystem::controllingTaskStarted if everything goes will, or shows error message if something wrong.
+     * It stops the sampling task if any and then starts controlling via #GestureEngine::startControllingTask .
      *
      * @param model_file : file path of the model file
      * @param keymap_file : file path of the keymap file
+     * @return if the controlling task started
      */
-    virtual void startControllingTask(const QString &model_file, const QString &keymap_file);
-    /**
-     * @brief stopControllingTask handles with the request of stopping controlling.
-     *
-     * It resets #GestureControlSystem::_work_status and emit the signal of #GestureControlSystem::controllingTaskStopped .
-     */
-    virtual void stopControllingTask();
+    bool startControllingTask(const QString &model_file, const QString &keymap_file) override;
 
     /**
      * @brief windowClosing is the callback function before the main window is closed.
@@ -241,34 +178,6 @@ public slots:
     void windowClosing();
 
 protected:
-    /**
-     * @brief _hand_detector is the #HandDetector used by this instance.
-     */
-    HandDetector *_hand_detector;
-    /**
-     * @brief _sample_collector is the #SampleCollector used by this instance.
-     */
-    SampleCollector *_sample_collector;
-    /**
-     * @brief _gesture_analyst is the #GestureAnalyst used by this instance.
-     */
-    GestureAnalystInterface *_gesture_analyst;
-    /**
-     * @brief _command_inputter is the #CommandInputter used by this instance.
-     */
-    CommandInputterInterface *_command_inputter;
-    /**
-     * @brief _work_status is the current work status.
-     *
-     * @see #GestureControlSystem::WORK_STATUS
-     */
-    WORK_STATUS _work_status;
-    /**
-     * @brief _camera_capture_timer is the timer of capturing frame form the camera.
-     *
-     * @see #GestureControlSystem::captureFrame
-     */
-    QTimer *_camera_capture_timer;
     /**
      * @brief _sampling_trails is an indicator of how many sampling trails have been conducted.
      *
@@ -290,25 +199,35 @@ protected:
     /**
      * @brief _handleCameraError is the callback function to handle the camera error.
      *
-     * It do the following by default:
-     *  - stop #GestureControlSystem::_camera_capture_timer
-     *  - emit #GestureControlSystem::cameraReleased() to inform the release of the camera.
+     * It calls #GestureEngine::_handleCameraError and shows the error message.
      */
-    virtual void _handleCameraError();
+    void _handleCameraError() override;
     /**
-     * @brief _processCapturedFrame is the callback function to deal with the frame captured by the camera.
+     * @brief _processCapturedFrame is the callback function to deal with a frame finished by #GestureEngine::_pipeline .
      *
      * It do the following by default:
      *
-     *  - detect the hand/gesture via #HandDetector from the region of interesting on the captured frame,
-     *  - make command via #CommandMaker using the analyst result obtained by #GestureAnalyst, and
-     *  - draw the region of interesting on the captured frame and show the captured frame on the tracking window.
+     *  - make command via #CommandInputter using the analyst result obtained by #GestureAnalyst, or do sampling, and
+     *  - show the intermediate images of #HandDetector on the monitor window.
+     *
+     * @param frame : the finished frame
+     *
+     * @see #GestureEngine::collectProcessedFrames
+     * @see #GestureControlSystem::_updateTrackingView
+     */
+    void _processCapturedFrame(FramePipeline::Frame &frame) override;
+    /**
+     * @brief _processNewestFrame updates the geometry of the pipeline to the tracking window and shows the newest frame via #GestureControlSystem::_updateTrackingView at most #PREVIEW_FPS times per second.
+     */
+    void _processNewestFrame(const FramePipeline::Frame &frame) override;
+    /**
+     * @brief _updateTrackingView renders the captured frame, draws the region of interesting on it and shows it on the tracking window.
      *
-     * @param captured_frame : the captured frame
+     * It is called with the newest finished frame at most #PREVIEW_FPS times per second.
      *
-     * @see #GestureControlSystem::captureFrame
+     * @param frame : the finished frame
      */
-    virtual void _processCapturedFrame(cv::Mat &captured_frame);
+    virtual void _updateTrackingView(const FramePipeline::Frame &frame);
 
     /**
      * @brief _sample does sampling via #SampleCollector::sample
@@ -328,20 +247,19 @@ protected:
      */
     virtual void _handleSamplingError(const SAMPLING_ERROR &e);
     /**
-     * @brief _recognize identifies gestures from the sample image via #GestureAnalyst:analyze and makes action using #CommandInputter::input .
-     * @param image : the sample image
+     * @brief _recognize makes action via #GestureEngine::_recognize and shows the predictions on the monitor window.
+     * @param predictions : the prediction results of the sample image, the best first
+     * @param tracked_point : the point tracked by #HandDetector
      */
-    virtual void _recognize(const cv::Mat &image, const cv::Point &tracked_point);
-    virtual void _handleControllingError(const CONTROLLING_ERROR &e);
+    void _recognize(const std::vector<GestureAnalystInterface::Prediction> &predictions, const cv::Point &tracked_point) override;
+    /**
+     * @brief _handleControllingError shows the error message and emits the signal of #GestureEngine::controllingTaskStopped .
+     */
+    void _handleControllingError(const CONTROLLING_ERROR &e) override;
 
 private:
-    Settings *_settings;
-
-    cv::Rect _roi;
-    cv::Rect _cursor_roi;
-
-    cv::VideoCapture *_camera;
-    size_t _camera_fps = CAMERA_FPS;
+    QElapsedTimer _preview_timer;
+    QElapsedTimer _latency_timer;
 
 };
 
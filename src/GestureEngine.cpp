@@ -0,0 +1,277 @@
+#include "GestureEngine.h"
+
+#include <QElapsedTimer>
+
+GestureEngine::GestureEngine(HandDetector *hand_detector, SampleCollector *sample_collector, GestureAnalystInterface *gesture_analyst, CommandInputterInterface *command_inputter, QObject *parent) :
+    QObject(parent),
+    camera_fps(_camera_fps),
+    work_status(_work_status),
+    roi(_roi),
+    cursor_roi(_cursor_roi),
+    stage_profiler(_stage_profiler),
+    _hand_detector(hand_detector),
+    _sample_collector(sample_collector),
+    _gesture_analyst(gesture_analyst),
+    _command_inputter(command_inputter),
+    _work_status(STATUS_IDLE),
+    _pipeline(new FramePipeline(hand_detector, sample_collector, gesture_analyst, this)),
+    _settings(Settings::getInstance()),
+    _frame_source(nullptr),
+    _camera_device(0),
+    _frame_width(0),
+    _frame_height(0),
+    _roi_start_x(DEFAULT_ROI_START_X),
+    _roi_end_x(DEFAULT_ROI_END_X),
+    _roi_start_y(DEFAULT_ROI_START_Y),
+    _roi_end_y(DEFAULT_ROI_END_Y),
+    _standby_timeout(_settings->standby_timeout),
+    _detection_tracking(_settings->detection_tracking)
+{
+    _pipeline->setStageProfiler(&_stage_profiler);
+    connect(_pipeline, SIGNAL(frameProcessed()), this, SLOT(collectProcessedFrames()), Qt::QueuedConnection);
+    connect(_pipeline, &FramePipeline::cameraFailed, this, &GestureEngine::_handleCameraError, Qt::QueuedConnection);
+}
+
+GestureEngine::~GestureEngine()
+{
+    // the capture thread reads from the source
+    _pipeline->stop();
+    delete _frame_source;
+}
+
+void GestureEngine::setCameraDevice(const int &device)
+{
+    _camera_device = device;
+}
+
+void GestureEngine::setCameraFps(const size_t &fps)
+{
+    _camera_fps = fps;
+}
+
+void GestureEngine::setFrameSource(FrameSourceInterface *source)
+{
+    _pipeline->stop();
+    delete _frame_source;
+    _frame_source = source;
+}
+
+bool GestureEngine::isCameraOpened() const
+{
+    return _frame_source != nullptr && _frame_source->isOpened();
+}
+
+void GestureEngine::setFrameGeometry(const int &width, const int &height)
+{
+    _frame_width = width;
+    _frame_height = height;
+    _pipeline->setFrameGeometry(width, height);
+}
+
+void GestureEngine::setRoiRange(const int &start_x, const int &end_x, const int &start_y, const int &end_y)
+{
+    _roi_start_x = start_x;
+    _roi_end_x = end_x;
+    _roi_start_y = start_y;
+    _roi_end_y = end_y;
+    _updateRoi();
+}
+
+void GestureEngine::setStandbyTimeout(const int &ms)
+{
+    _standby_timeout = ms;
+    _pipeline->setStandbyTimeout(_work_status == STATUS_CONTROLLING ? ms : 0);
+}
+
+void GestureEngine::setDetectionTracking(const bool &tracking)
+{
+    _detection_tracking = tracking;
+    QMetaObject::invokeMethod(_hand_detector, "setTracking",
+                              Q_ARG(bool, _work_status == STATUS_CONTROLLING && tracking));
+}
+
+void GestureEngine::_updateRoi()
+{
+    const int &start_x = _roi_start_x;
+    const int &end_x = _roi_end_x;
+    const int &start_y = _roi_start_y;
+    const int &end_y = _roi_end_y;
+    _roi.x = _frame_width * start_x/100;
+    _roi.y = _frame_height * start_y/100;
+    _roi.width = _frame_width * (end_x-start_x)/100;
+    _roi.height = _frame_height * (end_y-start_y)/100;
+
+    if (_roi.width < DEFAULT_ROI_MARGIN_LEFT + DEFAULT_ROI_MARGIN_RIGHT + 1)
+    {
+        _roi.width = DEFAULT_ROI_MARGIN_LEFT + DEFAULT_ROI_MARGIN_RIGHT + 1;
+        if (_roi.x + _roi.width > _frame_width)
+            _roi.x = _frame_width - _roi.width;
+    }
+    if (_roi.height < DEFAULT_ROI_MARGIN_TOP + DEFAULT_ROI_MARGIN_BOTTOM + 1)
+    {
+        _roi.height = DEFAULT_ROI_MARGIN_TOP + DEFAULT_ROI_MARGIN_BOTTOM + 1;
+        if (_roi.y + _roi.height > _frame_height)
+            _roi.y = _frame_height - _roi.height;
+    }
+    _cursor_roi.x = _roi.x + DEFAULT_ROI_MARGIN_LEFT;
+    _cursor_roi.y = _roi.y + DEFAULT_ROI_MARGIN_TOP;
+    _cursor_roi.width = _roi.width - DEFAULT_ROI_MARGIN_LEFT - DEFAULT_ROI_MARGIN_RIGHT;
+    _cursor_roi.height= _roi.height- DEFAULT_ROI_MARGIN_TOP - DEFAULT_ROI_MARGIN_BOTTOM;
+
+    _pipeline->setRoi(_roi);
+}
+
+void GestureEngine::applySettings()
+{
+    // the detector may live in the detection thread; queue the calls such that they arrive between two frames
+    QMetaObject::invokeMethod(_hand_detector, "setSkinColorFilterLowerBound",
+                              Q_ARG(int, _settings->skin_color_min_H),
+                              Q_ARG(int, _settings->skin_color_min_S),
+                              Q_ARG(int, _settings->skin_color_min_V));
+    QMetaObject::invokeMethod(_hand_detector, "setSkinColorFilterUpperBound",
+                              Q_ARG(int, _settings->skin_color_max_H),
+                              Q_ARG(int, _settings->skin_color_max_S),
+                              Q_ARG(int, _settings->skin_color_max_V));
+    QMetaObject::invokeMethod(_hand_detector, "setDetectionArea",
+                              Q_ARG(int, _settings->skin_detection_area));
+    QMetaObject::invokeMethod(_hand_detector, "setMorphology",
+                              Q_ARG(bool, _settings->skin_morphology));
+    QMetaObject::invokeMethod(_hand_detector, "setPyramidScale",
+                              Q_ARG(int, _settings->detection_pyramid_scale));
+    QMetaObject::invokeMethod(_hand_detector, "setMaxHands",
+                              Q_ARG(int, _settings->detection_max_hands));
+    QMetaObject::invokeMethod(_hand_detector, "setBackgroundLearningRate",
+                              Q_ARG(double, _settings->background_learning_rate));
+    setRoiRange(_settings->roi_start_x, _settings->roi_end_x, _settings->roi_start_y, _settings->roi_end_y);
+    setStandbyTimeout(_settings->standby_timeout);
+    setDetectionTracking(_settings->detection_tracking);
+}
+
+bool GestureEngine::openCamera()
+{
+    if (_frame_source == nullptr)
+        _frame_source = new CameraSource(_camera_device, _camera_fps);
+    if (!_frame_source->isOpened() && !_frame_source->open())
+    {
+        _handleCameraError();
+        return false;
+    }
+    if (_frame_width <= 0 || _frame_height <= 0)
+    {
+        const auto size = _frame_source->frameSize();
+        setFrameGeometry(size.width, size.height);
+        _updateRoi();
+    }
+    emit cameraOpened();
+    _pipeline->setRoi(_roi);
+    _pipeline->start(_frame_source);
+    return true;
+}
+
+void GestureEngine::releaseCamera()
+{
+    _pipeline->stop();
+    // FIXME exception caused by opencv when releasing the camera
+    //    if (_frame_source != nullptr)
+    //        _frame_source->release();
+}
+
+void GestureEngine::collectProcessedFrames()
+{
+    FramePipeline::Frame frame;
+    bool taken = false;
+    while (_pipeline->takeFrame(frame))
+    {
+        _processCapturedFrame(frame);
+        taken = true;
+    }
+    if (taken)
+        _processNewestFrame(frame);
+}
+
+bool GestureEngine::startControllingTask(const QString &model_file, const QString &keymap_file)
+{
+    if (_command_inputter->load(keymap_file))
+    {
+        if (_command_inputter->labels().empty())
+        {
+            _handleControllingError(CONTROLLING_ERROR_ILLEGAL_KEYMAP_FILE);
+            return false;
+        }
+        int num_labels = _gesture_analyst->load(model_file);
+
+        if (num_labels == _command_inputter->labels().size())
+        {
+            _setWorkStatus(STATUS_CONTROLLING);
+            _settings->setCnnModelFile(model_file);
+            _settings->setKeymapFile(keymap_file);
+            emit controllingTaskStarted();
+            return true;
+        }
+        _handleControllingError(CONTROLLING_ERROR_INVALID_KEYMAP_FILE);
+        return false;
+    }
+    _handleControllingError(CONTROLLING_ERROR_ILLEGAL_KEYMAP_FILE);
+    return false;
+}
+
+void GestureEngine::stopControllingTask()
+{
+    _setWorkStatus(STATUS_IDLE);
+    emit controllingTaskStopped();
+}
+
+void GestureEngine::_handleCameraError()
+{
+    _pipeline->stop();
+    emit cameraReleased();
+    qCritical() << "GestureEngine() -- Failed to read frames from the camera or the recording.";
+}
+
+void GestureEngine::_handleControllingError(const CONTROLLING_ERROR &e)
+{
+    if (e == CONTROLLING_ERROR_ILLEGAL_KEYMAP_FILE)
+        qCritical() << "GestureEngine() -- Unable to parse the keymap file.";
+    else
+        qCritical() << "GestureEngine() -- The keymap file is unmatched with the model file.";
+    emit controllingTaskStopped();
+}
+
+void GestureEngine::_processCapturedFrame(FramePipeline::Frame &frame)
+{
+    if (_work_status == STATUS_CONTROLLING && frame.detected && frame.analyzed)
+        _recognize(frame.predictions, frame.observation.tracked_point);
+}
+
+void GestureEngine::_processNewestFrame(const FramePipeline::Frame &)
+{}
+
+void GestureEngine::_recognize(const std::vector<GestureAnalystInterface::Prediction> &res, const cv::Point &tracked_point)
+{
+    QElapsedTimer timer;
+    timer.start();
+    _command_inputter->input(res[0].label_id,
+            static_cast<float>(tracked_point.x-DEFAULT_ROI_MARGIN_LEFT)/_cursor_roi.width,
+            static_cast<float>(tracked_point.y-DEFAULT_ROI_MARGIN_TOP)/_cursor_roi.height);
+    _stage_profiler.record(StageProfiler::STAGE_INPUT, timer.nsecsElapsed()/1000);
+}
+
+void GestureEngine::_setWorkStatus(const WORK_STATUS &status)
+{
+    _work_status = status;
+    // every frame detected while sampling must carry its hand image,
+    // so sampling is turned on before detecting and turned off after it
+    if (status == STATUS_SAMPLING)
+        _pipeline->setSampling(true);
+    _pipeline->setDetecting(status == STATUS_CONTROLLING || status == STATUS_SAMPLING);
+    _pipeline->setRecognizing(status == STATUS_CONTROLLING);
+    if (status != STATUS_SAMPLING)
+        _pipeline->setSampling(false);
+    // a sample must not be skipped, whereas the cursor must follow the newest hand position
+    _pipeline->setDropPolicy(status == STATUS_SAMPLING ? FramePipeline::NEVER_DROP : FramePipeline::DROP_OLDEST);
+    // a sample must not wait for the presence check either
+    _pipeline->setStandbyTimeout(status == STATUS_CONTROLLING ? _standby_timeout : 0);
+    // samples are taken across the whole ROI, as the hand may enter anywhere
+    QMetaObject::invokeMethod(_hand_detector, "setTracking",
+                              Q_ARG(bool, status == STATUS_CONTROLLING && _detection_tracking));
+}
@@ -0,0 +1,324 @@
+#ifndef GESTUREENGINE_H
+#define GESTUREENGINE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The GestureEngine.h file contains the class who drives the path from the camera through detection and recognition to commands, without any GUI.
+ */
+#include <vector>
+#include <QObject>
+#include <QString>
+#include <opencv2/opencv.hpp>
+
+#include "global.h"
+#include "Settings.h"
+#include "HandDetector.h"
+#include "SampleCollector.h"
+#include "FramePipeline.h"
+#include "StageProfiler.h"
+#include "FrameSourceInterface.h"
+#include "CameraSource.h"
+#include "GestureAnalystInterface.h"
+#include "CommandInputterInterface.h"
+
+/**
+ * @brief The GestureEngine class drives the frame source (the camera by default), the #FramePipeline and the #CommandInputterInterface, without any GUI.
+ *
+ * It is the core shared by the GUI application, where #GestureControlSystem extends it with the windows,
+ * and the headless `gesture-daemon`, which uses it directly.
+ * Errors are reported through the virtual `_handleXxxError` callbacks and signals; the default callbacks only log the error.
+ */
+class GestureEngine : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief WORK_STATUS represents the current work status of the system.
+     */
+    enum WORK_STATUS
+    {
+        STATUS_IDLE,         //!< idle
+        STATUS_CONTROLLING,  //!< controlling
+        STATUS_SAMPLING,     //!< sampling
+    };
+
+    /**
+     * @brief The CONTROLLING_ERROR represents the error appearing during controlling.
+     *
+     * @see #GestureEngine::_handleControllingError
+     */
+    enum CONTROLLING_ERROR
+    {
+        CONTROLLING_ERROR_ILLEGAL_KEYMAP_FILE, //!< illegal or invalid keymap file
+        CONTROLLING_ERROR_INVALID_KEYMAP_FILE  //!< the model file is unmatched with the provide network structure
+    };
+
+    /**
+     * @brief camera_fps is the FPS requested from the camera. The capture stage of #FramePipeline is paced by the camera.
+     */
+    const size_t &camera_fps;
+    /**
+     * @brief work_status is the current work status. This is a reference to #GestureEngine::_work_status.
+     *
+     * @see #GestureEngine::WORK_STATUS
+     */
+    const WORK_STATUS &work_status;
+    /**
+     * @brief roi is the region of interesting on the frame captured by the camera.
+     */
+    const cv::Rect &roi;
+    /**
+     * @brief cursor_roi is a modified ROI in the interior of #GestureEngine::roi to mapping cursor position from tracked point estimated by HandDetector.
+     */
+    const cv::Rect &cursor_roi;
+    /**
+     * @brief stage_profiler holds the latency of each stage of the frames processed. This is a reference to #GestureEngine::_stage_profiler.
+     */
+    const StageProfiler &stage_profiler;
+
+    explicit GestureEngine(HandDetector *hand_detector,
+                           SampleCollector *sample_collector,
+                           GestureAnalystInterface *gesture_analyst,
+                           CommandInputterInterface *command_inputter,
+                           QObject *parent = 0);
+    ~GestureEngine();
+
+    /**
+     * @brief setCameraDevice sets the index of the camera opened by #GestureEngine::openCamera . The default one is 0.
+     *
+     * It takes effect only if no frame source was set by #GestureEngine::setFrameSource .
+     */
+    void setCameraDevice(const int &device);
+    /**
+     * @brief setCameraFps sets the FPS requested from the camera.
+     *
+     * It takes effect only if no frame source was set by #GestureEngine::setFrameSource .
+     */
+    void setCameraFps(const size_t &fps);
+    /**
+     * @brief setFrameSource replaces the source from which frames are read, e.g. by a #ReplaySource .
+     *
+     * It stops the pipeline. The engine takes the ownership of the source and deletes the previous one.
+     * If no source is set, a #CameraSource is created by #GestureEngine::openCamera .
+     *
+     * @param source : the new frame source
+     */
+    void setFrameSource(FrameSourceInterface *source);
+    /**
+     * @brief isCameraOpened returns if the frame source is opened.
+     */
+    bool isCameraOpened() const;
+    /**
+     * @brief setFrameGeometry sets the size to which captured frames are fitted.
+     *
+     * An empty size keeps the size of the frames read from the camera.
+     * It does not change #GestureEngine::roi until #GestureEngine::setRoiRange is called.
+     *
+     * @param width : width of the fitted frame
+     * @param height : height of the fitted frame
+     */
+    void setFrameGeometry(const int &width, const int &height);
+    /**
+     * @brief setRoiRange verifies the given ROI range on the fitted frame and stores the verified range.
+     *
+     * If no frame geometry is known yet, the ROI is computed once #GestureEngine::openCamera knows the size of the frames.
+     *
+     * @param start_x : the left bound of the ROI in percent
+     * @param end_x : the right bound of the ROI in percent
+     * @param start_y : the top bound of the ROI in percent
+     * @param end_y : the bottom bound of the ROI in percent
+     */
+    void setRoiRange(const int &start_x, const int &end_x, const int &start_y, const int &end_y);
+    /**
+     * @brief setStandbyTimeout sets the time without any hand detected after which the controlling task goes into standby.
+     *
+     * It is #Settings::standby_timeout by default. Sampling never goes into standby.
+     *
+     * @param ms : the timeout in ms, or 0 to never go into standby
+     * @see #FramePipeline::setStandbyTimeout
+     */
+    void setStandbyTimeout(const int &ms);
+    /**
+     * @brief setDetectionTracking sets if the hand is searched around its last position while controlling.
+     *
+     * It is #Settings::detection_tracking by default. Sampling always searches the whole ROI.
+     *
+     * @param tracking : the flag to search around the last position or not
+     * @see #HandDetector::setTracking
+     */
+    void setDetectionTracking(const bool &tracking);
+    /**
+     * @brief applySettings configures the #HandDetector, the ROI, the standby timeout and the hand tracking according to #Settings .
+     *
+     * The GUI passes settings through the setting window instead; this is for running without it.
+     * Call it before #GestureEngine::openCamera such that the first frame is already processed with these settings.
+     */
+    void applySettings();
+
+signals:
+    /**
+     * @brief cameraOpened is the signal emitted right after the camera launched.
+     */
+    void cameraOpened();
+    /**
+     * @brief cameraReleased is the signal emitted right after the camera is released.
+     */
+    void cameraReleased();
+    /**
+     * @brief controllingTaskStarted is the signal to indicate the start of controlling task.
+     */
+    void controllingTaskStarted();
+    /**
+     * @brief controllingTaskStopped is the signal to indicate the stop of controlling task.
+     */
+    void controllingTaskStopped();
+
+public slots:
+    /**
+     * @brief openCamera opens the frame source and starts #GestureEngine::_pipeline .
+     *
+     * If no frame geometry was set, the size of the frames of the source is used.
+     *
+     * @retval true : if the camera is opened
+     * @retval false : if the camera cannot be opened. #GestureEngine::_handleCameraError is called.
+     */
+    virtual bool openCamera();
+    /**
+     * @brief releaseCamera stops #GestureEngine::_pipeline and closes the camera.
+     *
+     * **ATTENTION**:
+     *   This function cannot work properly on Mac OS (at least at Mac OS 10.12.3) due to the exception caused by opencv when releasing the camera on MAC OS
+     */
+    virtual void releaseCamera();
+    /**
+     * @brief collectProcessedFrames takes the finished frames from #GestureEngine::_pipeline and handles them.
+     *
+     * @see #GestureEngine::_processCapturedFrame
+     * @see #GestureEngine::_processNewestFrame
+     * @see #FramePipeline::frameProcessed
+     */
+    void collectProcessedFrames();
+    /**
+     * @brief startControllingTask starts a controlling task.
+     *
+     * It sets #GestureEngine::_work_status and emits the signal of #GestureEngine::controllingTaskStarted if everything goes will,
+     * or calls #GestureEngine::_handleControllingError if something wrong.
+     *
+     * @param model_file : file path of the model file
+     * @param keymap_file : file path of the keymap file
+     * @return if the controlling task started
+     */
+    virtual bool startControllingTask(const QString &model_file, const QString &keymap_file);
+    /**
+     * @brief stopControllingTask handles with the request of stopping controlling.
+     *
+     * It resets #GestureEngine::_work_status and emit the signal of #GestureEngine::controllingTaskStopped .
+     */
+    virtual void stopControllingTask();
+
+protected:
+    /**
+     * @brief _hand_detector is the #HandDetector used by this instance.
+     */
+    HandDetector *_hand_detector;
+    /**
+     * @brief _sample_collector is the #SampleCollector used by this instance.
+     */
+    SampleCollector *_sample_collector;
+    /**
+     * @brief _gesture_analyst is the #GestureAnalyst used by this instance.
+     */
+    GestureAnalystInterface *_gesture_analyst;
+    /**
+     * @brief _command_inputter is the #CommandInputter used by this instance.
+     */
+    CommandInputterInterface *_command_inputter;
+    /**
+     * @brief _work_status is the current work status.
+     *
+     * @see #GestureEngine::WORK_STATUS
+     */
+    WORK_STATUS _work_status;
+    /**
+     * @brief _pipeline is the pipeline who captures frames from the camera and analyzes them.
+     *
+     * @see #GestureEngine::collectProcessedFrames
+     */
+    FramePipeline *_pipeline;
+    /**
+     * @brief _settings is an instance of #Settings .
+     */
+    Settings *_settings;
+    /**
+     * @brief _frame_source is the source from which frames are captured.
+     */
+    FrameSourceInterface *_frame_source;
+    /**
+     * @brief _stage_profiler collects the latency of the stages from the pipeline and of making commands.
+     *
+     * Subclasses record their own stages, e.g. #StageProfiler::STAGE_PIXMAP, into it.
+     */
+    StageProfiler _stage_profiler;
+
+    /**
+     * @brief _handleCameraError is the callback function to handle the camera error.
+     *
+     * It do the following by default:
+     *  - stop #GestureEngine::_pipeline
+     *  - emit #GestureEngine::cameraReleased() to inform the release of the camera, and
+     *  - log the error.
+     */
+    virtual void _handleCameraError();
+    /**
+     * @brief _handleControllingError is the callback function when the controlling task cannot start.
+     *
+     * It logs the error and emits the signal of #GestureEngine::controllingTaskStopped by default.
+     */
+    virtual void _handleControllingError(const CONTROLLING_ERROR &e);
+    /**
+     * @brief _processCapturedFrame is the callback function to deal with a frame finished by #GestureEngine::_pipeline .
+     *
+     * By default, it makes command via #GestureEngine::_recognize using the analyst result obtained by #GestureAnalyst when controlling.
+     *
+     * @param frame : the finished frame
+     */
+    virtual void _processCapturedFrame(FramePipeline::Frame &frame);
+    /**
+     * @brief _processNewestFrame is called once with the newest frame after all the finished frames were passed to #GestureEngine::_processCapturedFrame .
+     *
+     * It does nothing by default. It is the place to do display work which does not need to run for every frame.
+     *
+     * @param frame : the newest finished frame
+     */
+    virtual void _processNewestFrame(const FramePipeline::Frame &frame);
+    /**
+     * @brief _recognize makes action using #CommandInputter::input according to the gestures identified by #GestureAnalyst::analyze .
+     * @param predictions : the prediction results of the sample image, the best first
+     * @param tracked_point : the point tracked by #HandDetector
+     */
+    virtual void _recognize(const std::vector<GestureAnalystInterface::Prediction> &predictions, const cv::Point &tracked_point);
+    /**
+     * @brief _setWorkStatus sets #GestureEngine::_work_status and tells #GestureEngine::_pipeline what to do on each frame.
+     * @param status : the new work status
+     */
+    void _setWorkStatus(const WORK_STATUS &status);
+
+private:
+    cv::Rect _roi;
+    cv::Rect _cursor_roi;
+
+    int _camera_device;
+    size_t _camera_fps = CAMERA_FPS;
+    int _frame_width;
+    int _frame_height;
+    int _roi_start_x;
+    int _roi_end_x;
+    int _roi_start_y;
+    int _roi_end_y;
+    int _standby_timeout;
+    bool _detection_tracking;
+
+    void _updateRoi();
+};
+
+#endif // GESTUREENGINE_H
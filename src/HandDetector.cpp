@@ -1,5 +1,9 @@
 #include "HandDetector.h"
 
+#include <QElapsedTimer>
+
+#include "ParallelInvoker.h"
+
 const cv::Scalar HandDetector::COLOR_BLACK(cv::Scalar(0,0,0,255));
 const cv::Scalar HandDetector::COLOR_WHITE(cv::Scalar(255,255,255,255));
 const cv::Scalar HandDetector::COLOR_GRAY(cv::Scalar(127, 127, 127, 255));
@@ -7,23 +11,19 @@ const cv::Scalar HandDetector::COLOR_RED(cv::Scalar(0,0,255,255));
 const cv::Scalar HandDetector::COLOR_GREEN(cv::Scalar(0,255,0,255));
 const cv::Scalar HandDetector::COLOR_BLUE(cv::Scalar(255,0,0,255));
 
+namespace
+{
+
+// the bounds of the angle at the farthest point of a finger defect, 15 and 135 degrees, as squared cosines
+const double COS2_MIN_FINGER_ANGLE = std::cos(0.2618)*std::cos(0.2618);
+const double COS2_MAX_FINGER_ANGLE = std::cos(2.3562)*std::cos(2.3562);
+// the minimum distance between two finger tops
+const int FINGER_MERGE_DISTANCE = 30;
+
+}
+
 HandDetector::HandDetector(QObject *parent) :
     QObject(parent),
-    interesting_img(_interesting_img),
-    filtered_img(_filtered_img),
-    convexity_img(_convexity_img),
-    extracted_img(_extracted_img),
-    background_img(_background_img),
-    skin_color_lower_bound(_skin_color_lower_bound),
-    skin_color_upper_bound(_skin_color_upper_bound),
-    morphology(_morphology),
-    detection_area(_detection_area),
-    tracked_point(_tracked_point),
-    fingers(_fingers),
-    hand_center(_hand_center),
-    palm_radius(_palm_radius),
-    waitting_bg(_waitting_bg),
-    _bg_subtractor(cv::createBackgroundSubtractorMOG2(1, 16, false)),
     _has_set_bg(false),
     _waitting_bg(false),
     _skin_color_lower_bound(cv::Scalar(DEFAULT_SKIN_COLOR_MIN_H, DEFAULT_SKIN_COLOR_MIN_S, DEFAULT_SKIN_COLOR_MIN_V)),
@@ -32,16 +32,133 @@ HandDetector::HandDetector(QObject *parent) :
     _gaussian_variance(0.8),
     _morphology(DEFAULT_SKIN_MORPHOLOGY),
     _morphology_kernel(cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(9, 9))),
-    _detection_area(DEFAULT_SKIN_DETECTION_AREA)
-{}
+    _detection_area(DEFAULT_SKIN_DETECTION_AREA),
+    _pyramid_scale(DEFAULT_DETECTION_PYRAMID_SCALE),
+    _max_hands(DEFAULT_DETECTION_MAX_HANDS),
+    _tracking(false),
+    _tracked_frames(0),
+    _fingers_predicted(false),
+    _hull_area(0),
+    _predicted_frames(0),
+    _estimated_palm_radius(0),
+    _preprocessing_us(0),
+    _finger_extraction_us(0),
+    _hand_count(0)
+{
+    qRegisterMetaType<cv::Mat>("cv::Mat");
+}
 
 bool HandDetector::detect(const cv::Mat &input_img)
 {
-    input_img.copyTo(_interesting_img);
-    _imagePreprocessing();
-    return _fingerExtraction();
+    return _detect(input_img, false);
+}
+
+bool HandDetector::detectShared(const cv::Mat &input_img)
+{
+    return _detect(input_img, true);
+}
+
+bool HandDetector::_detect(const cv::Mat &input_img, const bool &share)
+{
+    QElapsedTimer timer;
+    timer.start();
+    const cv::Rect whole(0, 0, input_img.cols, input_img.rows);
+    if (input_img.size() != _interesting_img.size())
+        _resetTracking();
+    _setInput(input_img, share);
+    // the same table for the whole detection, rebuilt in the background if the bounds changed
+    _skin_table.requestBounds(_skin_color_lower_bound, _skin_color_upper_bound);
+    _subtractBackground();
+    _preprocessing_us = 0;
+    _finger_extraction_us = 0;
+
+    bool detected = false;
+    if (_tracking && _max_hands == 1 && _track_bound.area() > 0 && _tracked_frames < DETECTION_TRACKING_REFRESH)
+    {
+        // search around where the hand is expected
+        const int grow = std::max(_track_bound.width, _track_bound.height)*DETECTION_TRACKING_MARGIN/100 + _filterRadius();
+        _search_area = cv::Rect(_track_bound.x + _track_velocity.x - grow - std::abs(_track_velocity.x),
+                                _track_bound.y + _track_velocity.y - grow - std::abs(_track_velocity.y),
+                                _track_bound.width + 2*(grow + std::abs(_track_velocity.x)),
+                                _track_bound.height + 2*(grow + std::abs(_track_velocity.y))) & whole;
+        _imagePreprocessing(_search_area);
+        _preprocessing_us += timer.nsecsElapsed()/1000;
+        timer.start();
+        detected = _fingerExtraction(_search_area);
+        // the hand may go beyond the window where the filters near its edges are not exact
+        if (detected)
+        {
+            const int r = _filterRadius();
+            const int left = _search_area.x > 0 ? r : 0;
+            const int top = _search_area.y > 0 ? r : 0;
+            const int right = _search_area.br().x < whole.width ? r : 0;
+            const int bottom = _search_area.br().y < whole.height ? r : 0;
+            const cv::Rect inner(_search_area.x + left, _search_area.y + top,
+                                 _search_area.width - left - right, _search_area.height - top - bottom);
+            detected = (_contour_bound & inner) == _contour_bound;
+        }
+        _finger_extraction_us += timer.nsecsElapsed()/1000;
+        timer.start();
+        if (!detected)
+            _resetTracking();
+    }
+
+    if (!detected)
+    {
+        _search_area = whole;
+        // only the neighbourhood of the candidate regions found on the shrunk image is filtered at full resolution
+        if (_pyramid_scale > 1 && !_locateCandidates(_search_area))
+            _search_area = cv::Rect();
+        _imagePreprocessing(_search_area);
+        _preprocessing_us += timer.nsecsElapsed()/1000;
+        timer.start();
+        detected = _fingerExtraction(_search_area);
+        _finger_extraction_us += timer.nsecsElapsed()/1000;
+    }
+
+    // the finger tops are followed even if the hand is not tracked, and forgotten if it is lost
+    if (!detected)
+    {
+        _hull_bound = cv::Rect();
+        _finger_tracker.update(_fingers, _finger_ids);
+    }
+    else if (_fingers_predicted)
+        _finger_tracker.predict(_fingers, _finger_ids);
+    else
+        _finger_tracker.update(_fingers, _finger_ids);
+
+    if (detected && _tracking)
+    {
+        if (_track_bound.area() > 0)
+        {
+            const auto shift = _contour_bound.tl() + _contour_bound.br() - _track_bound.tl() - _track_bound.br();
+            _track_velocity = cv::Point(shift.x/2, shift.y/2);
+        }
+        _track_bound = _contour_bound;
+        ++_tracked_frames;
+    }
+    return detected;
+}
+
+void HandDetector::preprocess(const cv::Mat &input_img)
+{
+    _setInput(input_img, false);
+    _skin_table.requestBounds(_skin_color_lower_bound, _skin_color_upper_bound);
+    _subtractBackground();
+    _imagePreprocessing(cv::Rect(0, 0, _interesting_img.cols, _interesting_img.rows));
 }
 
+bool HandDetector::checkPresence(const cv::Mat &input_img, const int &scale)
+{
+    if (input_img.empty())
+        return false;
+    const auto size = cv::Size(std::max(1, input_img.cols/scale), std::max(1, input_img.rows/scale));
+    cv::resize(input_img, _presence_img, size, 0, 0, cv::INTER_NEAREST);
+    _skin_table.requestBounds(_skin_color_lower_bound, _skin_color_upper_bound);
+    _skin_table.classify(_presence_img, _presence_mask,
+                         _has_set_bg && _background.reference().size() == input_img.size() ? _background.reference(size) : cv::Mat());
+    return 2*cv::countNonZero(_presence_mask)*scale*scale >= _detection_area;
+}
 
 void HandDetector::setMorphology(const bool &perform_morphology)
 {
@@ -63,6 +180,22 @@ void HandDetector::setDetectionArea(const int &area)
     _detection_area = area;
 }
 
+void HandDetector::setPyramidScale(const int &scale)
+{
+    _pyramid_scale = scale > 1 ? scale : 1;
+}
+
+void HandDetector::setMaxHands(const int &hands)
+{
+    _max_hands = hands > 1 ? hands : 1;
+}
+
+void HandDetector::setTracking(const bool &tracking)
+{
+    _tracking = tracking;
+    _resetTracking();
+}
+
 void HandDetector::setBackgroundImage()
 {
     if (_interesting_img.empty())
@@ -74,153 +207,309 @@ void HandDetector::clearBackgroundImage()
 {
     _has_set_bg = false;
     _waitting_bg = false;
+    _background.clear();
     emit backgroundImageCleared();
 }
 
-void HandDetector::_imagePreprocessing()
+void HandDetector::setBackgroundLearningRate(const double &rate)
+{
+    _background.setLearningRate(rate);
+}
+
+void HandDetector::_setInput(const cv::Mat &input_img, const bool &share)
+{
+    // the copy goes into a buffer of its own, never into an image shared by the last call
+    if (share)
+        _interesting_img = input_img;
+    else
+    {
+        input_img.copyTo(_input_buffer);
+        _interesting_img = _input_buffer;
+    }
+}
+
+void HandDetector::_resetTracking()
+{
+    _track_bound = cv::Rect();
+    _track_velocity = cv::Point();
+    _tracked_frames = 0;
+    _hull_bound = cv::Rect();
+    _predicted_frames = 0;
+}
+
+int HandDetector::_filterRadius() const
 {
-    // background subtractor
+    return _gaussian_size.width/2 + (_morphology ? 4*(_morphology_kernel.cols/2) : 0);
+}
+
+void HandDetector::_subtractBackground()
+{
+    // the difference from the background is tested by the skin color filter later
     if (_waitting_bg == true)
     {
-        _bg_subtractor->apply(_interesting_img, _bg, 1);
+        _background.setReference(_interesting_img);
         _has_set_bg = true;
         _waitting_bg = false;
-        _interesting_img.copyTo(_background_img);
-        emit backgroundImageSet();
+        // a copy of its own, such that the receiver on another thread reads it while the detector goes on
+        emit backgroundImageSet(_interesting_img.clone());
     }
-    if (_has_set_bg == true)
+    else if (_has_set_bg == true)
+        _background.update(_interesting_img);
+}
+
+const cv::Mat &HandDetector::_backgroundOf(const cv::Size &size)
+{
+    static const cv::Mat none;
+    // a background of another size, e.g. before the ROI changed, leaves every pixel as foreground
+    if (!_has_set_bg || _background.reference().size() != _interesting_img.size())
+        return none;
+    return _background.reference(size);
+}
+
+bool HandDetector::_locateCandidates(cv::Rect &area)
+{
+    const int &s = _pyramid_scale;
+    const cv::Size coarse_size(std::max(1, _interesting_img.cols/s), std::max(1, _interesting_img.rows/s));
+    cv::resize(_interesting_img, _coarse_img, coarse_size, 0, 0, cv::INTER_NEAREST);
+    _skin_table.classify(_coarse_img, _mask_buffer, _backgroundOf(coarse_size));
+    // the blur joins the pieces of a region broken by the shrinking
+    _mask.blurThreshold(_mask_buffer, _gaussian_size, _gaussian_variance, 10);
+    _mask.unpack(_coarse_mask);
+
+    _coarse_components.label(_coarse_mask);
+    // keep every region who may reach the detection area at full resolution, such that the largest one is still chosen there
+    cv::Rect bound;
+    for (const auto &c : _coarse_components.components())
     {
-        _bg_subtractor->apply(_interesting_img, _bg, 0);
-        _interesting_img.copyTo(_filtered_img, _bg);
+        if (2*c.area*s*s < _detection_area)
+            continue;
+        bound = bound.area() == 0 ? c.bound : (bound | c.bound);
     }
-    else
-        _interesting_img.copyTo(_filtered_img);
-
-    // skin color filter
-    cv::cvtColor(_filtered_img, _filtered_img, cv::COLOR_RGB2HSV);
-    cv::inRange(_filtered_img, _skin_color_lower_bound, _skin_color_upper_bound, _filtered_img);
-    // smooth
-    cv::GaussianBlur(_filtered_img, _filtered_img, _gaussian_size, _gaussian_variance);
-    // thresholding
-    cv::threshold(_filtered_img, _filtered_img, 10, 255, cv::THRESH_BINARY);
-    // morphological transformation
-    if (_morphology)
+    if (bound.area() == 0)
+        return false;
+
+    // a region at full resolution may exceed its shrunk one by the shrinking, the blur and the closing,
+    // and the filters are exact only farther than their radius from the border of the filtered area
+    const int margin = s + _gaussian_size.width/2 + (_morphology ? _morphology_kernel.cols/2 : 0) + _filterRadius();
+    area = cv::Rect(bound.x*s - margin, bound.y*s - margin, bound.width*s + 2*margin, bound.height*s + 2*margin)
+            & cv::Rect(0, 0, _interesting_img.cols, _interesting_img.rows);
+    return true;
+}
+
+void HandDetector::_imagePreprocessing(const cv::Rect &area)
+{
+    _filtered_img.create(_interesting_img.size(), CV_8UC1);
+    if (area.area() == 0)
+    {
+        _filtered_img.setTo(0);
+        return;
+    }
+    if (area.size() != _interesting_img.size())
+        _filtered_img.setTo(0);
+
+    const cv::Mat &background = _backgroundOf(_interesting_img.size());
+    // the chain of stages specialized for the settings
+    static const BandPreprocessor preprocessors[2][2] = {
+        {&HandDetector::_preprocessBand<false, false>, &HandDetector::_preprocessBand<false, true>},
+        {&HandDetector::_preprocessBand<true, false>, &HandDetector::_preprocessBand<true, true>}
+    };
+    const auto preprocess = preprocessors[background.empty() ? 0 : 1][_morphology ? 1 : 0];
+    const int bands = std::max(1, area.height/PREPROCESSING_BAND_ROWS);
+    if (bands == 1)
     {
-        cv::morphologyEx(_filtered_img, _filtered_img, cv::MORPH_OPEN, _morphology_kernel);
-        cv::morphologyEx(_filtered_img, _filtered_img,cv::MORPH_CLOSE, _morphology_kernel);
+        (this->*preprocess)(area, background, 0, area.height, _mask, _mask_buffer);
+        return;
     }
+    if (_band_masks.size() < static_cast<std::size_t>(2*bands))
+        _band_masks.resize(2*bands);
+    parallelFor(cv::Range(0, bands), [&](const cv::Range &range) {
+        for (int i = range.start; i < range.end; ++i)
+            (this->*preprocess)(area, background, i*area.height/bands, (i+1)*area.height/bands, _band_masks[2*i], _band_masks[2*i+1]);
+    }, bands);
 }
 
-bool HandDetector::_fingerExtraction()
+template <bool BACKGROUND, bool MORPHOLOGY>
+void HandDetector::_preprocessBand(const cv::Rect &area, const cv::Mat &background, const int &top, const int &bottom,
+                                   BinaryMask &mask, BinaryMask &buffer)
+{
+    // the rows within the radius of the filters are added to the band, such that its own rows are exact
+    const int halo = _gaussian_size.width/2 + (MORPHOLOGY ? 4*(_morphology_kernel.cols/2) : 0);
+    const int first = std::max(0, top - halo);
+    const int last = std::min(area.height, bottom + halo);
+    const cv::Rect band(area.x, area.y + first, area.width, last - first);
+
+    // skin color filter, which treats the pixels of the background as black ones
+    _skin_table.classify(_interesting_img(band), buffer, BACKGROUND ? background(band) : cv::Mat());
+    // smooth and thresholding, on the bit-packed mask
+    mask.blurThreshold(buffer, _gaussian_size, _gaussian_variance, 10);
+    // morphological transformation, i.e. opening and closing
+    if (MORPHOLOGY)
+    {
+        buffer.erode(mask, _morphology_kernel);
+        mask.dilate(buffer, _morphology_kernel);
+        buffer.dilate(mask, _morphology_kernel);
+        mask.erode(buffer, _morphology_kernel);
+    }
+    cv::Mat filtered_band = _filtered_img(cv::Rect(area.x, area.y + top, area.width, bottom - top));
+    mask.unpack(filtered_band, top - first);
+}
+
+bool HandDetector::_fingerExtraction(const cv::Rect &search_area)
 {
-    std::vector<std::vector<cv::Point> > contours;
-    double area, largest_area = 0, thresh = 0.9*_filtered_img.rows*_filtered_img.cols;
-    _convexity_img = cv::Mat(_filtered_img.rows, _filtered_img.cols, CV_8UC3);
-    _convexity_img.setTo(HandDetector::COLOR_WHITE);
     _extracted_img.release();
+    _hand_contour.clear();
+    _hand_bound = cv::Rect();
     _fingers.clear();
+    _finger_ids.clear();
+    _fingers_predicted = false;
     _tracked_point.x = -1;
     _tracked_point.y = -1;
     _hand_center.x = -1;
     _hand_center.y = -1;
     _palm_radius = 0;
+    _contour_bound = cv::Rect();
+    _hand_count = 0;
+    if (search_area.area() == 0)
+        return false;
 
-    // contour extraction
-    cv::findContours(_filtered_img, contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_NONE);
-    int indx = -1;
-    for (int i = static_cast<int>(contours.size()); --i > -1;)
+    // label the regions, in the coordinates of the whole image, and choose the largest ones,
+    // by their pixel counts, which are never below the areas within their contours rechecked in _analyzeHand
+    _components.label(_filtered_img(search_area), search_area.tl());
+    const auto &components = _components.components();
+    _hand_components.clear();
+    for (int i = 0; i < static_cast<int>(components.size()); ++i)
     {
-        area = cv::contourArea(contours[i]);
-        if (area > _detection_area && area > largest_area)
+        if (components[i].area <= _detection_area)
+            continue;
+        // after those of the same area, such that the first region found is chosen among regions of the same area
+        auto pos = std::upper_bound(_hand_components.begin(), _hand_components.end(), components[i].area,
+                                    [&components](const int &area, const int &c) -> bool
         {
-            largest_area = area;
-            indx = i;
-        }
+            return area > components[c].area;
+        });
+        if (pos - _hand_components.begin() >= _max_hands)
+            continue;
+        _hand_components.insert(pos, i);
+        if (static_cast<int>(_hand_components.size()) > _max_hands)
+            _hand_components.pop_back();
+    }
+    if (_hand_components.empty())
+        return false;
+
+    // each region is traced and analyzed on its own buffers, in parallel
+    const int n = static_cast<int>(_hand_components.size());
+    if (static_cast<int>(_hands.size()) < n)
+        _hands.resize(n);
+    if (n == 1)
+        _hands[0].analyzed = _traceHand(_hands[0], _hand_components[0]);
+    else
+        parallelFor(cv::Range(0, n), [this](const cv::Range &range)
+        {
+            for (int i = range.start; i < range.end; ++i)
+                _hands[i].analyzed = _traceHand(_hands[i], _hand_components[i]);
+        }, n);
+    // the regions failing the recheck are dropped, such that the largest one passing it becomes the tracked hand
+    for (int i = 0; i < n; ++i)
+    {
+        if (!_hands[i].analyzed)
+            continue;
+        if (i != _hand_count)
+            std::swap(_hands[i], _hands[_hand_count]);
+        ++_hand_count;
     }
-    // fail if no contour extraction
-    if (indx == -1 || largest_area > thresh)
+    if (_hand_count == 0)
+        return false;
+    if (_hand_count == 1)
+        _analyzeHand(_hands[0], true);
+    else
+        parallelFor(cv::Range(0, _hand_count), [this](const cv::Range &range)
+        {
+            for (int i = range.start; i < range.end; ++i)
+                _analyzeHand(_hands[i], i == 0);
+        }, _hand_count);
+
+    auto &hand = _hands[0];
+    _contour_bound = hand.contour_bound;
+    _tracked_point = hand.tracked_point;
+    _hand_center = hand.hand_center;
+    _palm_radius = hand.palm_radius;
+    _hand_bound = hand.hand_bound;
+    _extracted_img = _filtered_img(_hand_bound);
+    // swapped rather than copied, such that both buffers are reused
+    _fingers.swap(hand.fingers);
+    _hand_contour.swap(hand.contours[0]);
+
+    return true;
+}
+
+bool HandDetector::_traceHand(Hand &hand, const int &component)
+{
+    const cv::Rect &bound = _components.components()[component].bound;
+    auto &contours = hand.contours;
+
+    // contour extraction of the region alone, drawn with a black border on the buffer of the distance transform below
+    const cv::Rect blob_area = cv::Rect(bound.x - 1, bound.y - 1, bound.width + 2, bound.height + 2)
+            & cv::Rect(0, 0, _filtered_img.cols, _filtered_img.rows);
+    hand.mask.create(_filtered_img.rows, _filtered_img.cols, CV_8UC1);
+    cv::Mat blob_mask = hand.mask(blob_area);
+    blob_mask.setTo(0);
+    _components.draw(component, blob_mask, blob_area.tl());
+    cv::findContours(blob_mask, contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_NONE, blob_area.tl());
+    // a 8-connected region has one outer contour
+    if (contours.empty())
         return false;
+    // the same thresholds as on the area within the contour, i.e. fail if the region is too small after all,
+    // or if it covers almost everything
+    const double contour_area = cv::contourArea(contours[0]);
+    return contour_area > _detection_area && contour_area <= 0.9*_filtered_img.rows*_filtered_img.cols;
+}
 
-    std::vector<cv::Point> contour;
-    std::vector<std::vector<int> > hulls(1);
-    std::vector<cv::Vec4i> defects;
-    std::vector<int> farthest_points;
-    double dist1, dist2, angle;
-    bool flag1, flag2;
+void HandDetector::_analyzeHand(Hand &hand, const bool &primary)
+{
+    const auto &contours = hand.contours;
+    const int indx = 0;
+    hand.fingers.clear();
+
+    auto &contour = hand.polygon;
+    auto &farthest_points = hand.farthest_points;
+    double dist1;
 
     cv::Rect hand_bound = cv::boundingRect(contours[indx]);
+    hand.contour_bound = hand_bound;
 
     // approximate contour region using polygon
     cv::approxPolyDP(contours[indx], contour, 10.0, true);
-    // extract convexity defects
-    cv::convexHull(contour, hulls[0], false);
-    cv::convexityDefects(contour, hulls[0], defects);
-    // estimate finger tops
-
-    for (const auto &d : defects)
+    // extract convex hull, and estimate finger tops unless those of the largest region are predicted
+    cv::convexHull(contour, hand.hull, false);
+    double hull_area = 0;
+    if (primary)
     {
-        // discard those whose start and end points are too far or too close
-        dist1 = _squaredEuclidDist<cv::Point, cv::Point>(contour[d[0]], contour[d[2]]);
-        if (dist1 < 100 || dist1 > 30000)
-            continue;
-        dist2 = _squaredEuclidDist<cv::Point, cv::Point>(contour[d[1]], contour[d[2]]);
-        if (dist2 < 100 || dist2 > 30000)
-            continue;
-        // discard those from which the angle formed is twoo small or big
-        angle = std::acos(
-                    double(
-                        (contour[d[0]].x - contour[d[2]].x)*(contour[d[1]].x - contour[d[2]].x)
-                +(contour[d[0]].y - contour[d[2]].y)*(contour[d[1]].y - contour[d[2]].y)
-                ) / std::sqrt(dist1 * dist2)
-                );
-        if (angle < 0.2618 || angle > 2.3562) // 15 degree, 135 degree
-            continue;
-        // keep those start or end points who are not too far from those who have been kept
-        flag1 = true; flag2 = true;
-        for (const auto &p : _fingers)
-        {
-            if (flag1 && _squaredEuclidDist<cv::Point, cv::Point>(contour[d[0]], p) < 900)
-                flag1 = false;
-            if (flag2)
-            {
-                if (_squaredEuclidDist(contour[d[1]], p) < 900)
-                    flag2 = false;
-
-            }
-            else if (flag1 == false)
-                break;
-        }
-        if (flag1)
-        {
-            if (flag2)
-            {
-                if (_squaredEuclidDist<cv::Point, cv::Point>(contour[d[1]], contour[d[0]]) < 1000)
-                {
-                    if (contour[d[0]].y < contour[d[1]].y)
-                        _fingers.push_back(contour[d[0]]);
-                    else
-                        _fingers.push_back(contour[d[1]]);
-                }
-                else
-                {
-                    _fingers.push_back(contour[d[0]]);
-                    _fingers.push_back(contour[d[1]]);
-                }
-            }
-            else
-                _fingers.push_back(contour[d[0]]);
-            farthest_points.push_back(d[2]);
-        }
-        else if (flag2)
+        for (std::size_t k = 0, l = hand.hull.size() - 1; k < hand.hull.size(); l = k++)
+            hull_area += contour[hand.hull[l]].x*contour[hand.hull[k]].y - contour[hand.hull[k]].x*contour[hand.hull[l]].y;
+        hull_area = std::abs(hull_area)/2;
+        _fingers_predicted = _tracking && _predicted_frames < FINGER_TRACKING_REFRESH && _hull_bound.area() > 0
+                && std::abs(hand.contour_bound.width - _hull_bound.width) <= FINGER_TRACKING_HULL_TOLERANCE
+                && std::abs(hand.contour_bound.height - _hull_bound.height) <= FINGER_TRACKING_HULL_TOLERANCE
+                // as much as the bounding box grows by the tolerance on each side
+                && std::abs(hull_area - _hull_area) <= FINGER_TRACKING_HULL_TOLERANCE*(_hull_bound.width + _hull_bound.height);
+    }
+    const bool predicted = primary && _fingers_predicted;
+    if (predicted)
+        ++_predicted_frames;
+    else
+    {
+        _fingerTops(hand);
+        if (primary)
         {
-            _fingers.push_back(contour[d[1]]);
-            farthest_points.push_back(d[2]);
+            _hull_bound = hand.contour_bound;
+            _hull_area = hull_area;
+            _predicted_frames = 0;
         }
     }
 
     // we always use the top most point as the track point
     //    if (_fingers.empty())
-    _tracked_point = *std::min_element(
+    hand.tracked_point = *std::min_element(
                 contour.begin(), contour.end(),
                 [](const cv::Point &lhs, const cv::Point &rhs) -> bool
     {
@@ -239,48 +528,218 @@ bool HandDetector::_fingerExtraction()
     //        _hand_center.x = mom.m10/mom.m00;
     //        _hand_center.y = mom.m01/mom.m00;
 
-    // estimate hand center via distance transformation
-    cv::Mat _dist_img(_convexity_img.rows, _convexity_img.cols, CV_8UC1);
-    cv::drawContours(_dist_img, contours, indx, cv::Scalar(255), -1);
-    cv::distanceTransform(_dist_img, _dist_img, CV_DIST_L2, 3);
+    // estimate hand center via distance transformation,
+    // only on the bounding box with a black border of one pixel, which every path from the hand to the rest of the image crosses
+    const cv::Rect dist_area = cv::Rect(hand.contour_bound.x - 1, hand.contour_bound.y - 1, hand.contour_bound.width + 2, hand.contour_bound.height + 2)
+            & cv::Rect(0, 0, _filtered_img.cols, _filtered_img.rows);
+    hand.dist_img.create(_filtered_img.rows, _filtered_img.cols, CV_32FC1);
+    cv::Mat hand_mask = hand.mask(dist_area);
+    cv::Mat dist_img = hand.dist_img(dist_area);
+    hand_mask.setTo(0);
+    cv::drawContours(hand_mask, contours, indx, cv::Scalar(255), -1, 8, cv::noArray(), 0, cv::Point(-dist_area.x, -dist_area.y));
+    cv::distanceTransform(hand_mask, dist_img, CV_DIST_L2, 3);
     cv::Point _;
     double min,max;
-    cv::minMaxLoc(_dist_img, &min, &max, &_, &_hand_center);
+    cv::minMaxLoc(dist_img, &min, &max, &_, &hand.hand_center);
+    hand.hand_center += dist_area.tl();
 
-    // estimate palm radius
-    if (farthest_points.empty())
+    // estimate palm radius, the same as on the last frame if the finger tops are predicted
+    if (predicted)
+    {
+        hand.palm_radius = _estimated_palm_radius;
+    }
+    else if (farthest_points.empty())
     {
-        _palm_radius = 0.8*std::sqrt(_squaredEuclidDist<cv::Point, cv::Point>(_tracked_point, _hand_center));
+        hand.palm_radius = 0.8*std::sqrt(_squaredEuclidDist<cv::Point, cv::Point>(hand.tracked_point, hand.hand_center));
     }
     else
     {
-        _palm_radius = 100000000;
+        hand.palm_radius = 100000000;
         for (const auto & i : farthest_points)
         {
-            dist1 = _squaredEuclidDist<cv::Point, cv::Point>(contour[i], _hand_center);
-            if (dist1 < _palm_radius)
-                _palm_radius = std::move(dist1);
+            dist1 = _squaredEuclidDist<cv::Point, cv::Point>(contour[i], hand.hand_center);
+            if (dist1 < hand.palm_radius)
+                hand.palm_radius = std::move(dist1);
         }
-        _palm_radius = 1.2*std::sqrt(_palm_radius);
+        hand.palm_radius = 1.2*std::sqrt(hand.palm_radius);
     }
-    int new_height = _hand_center.y-hand_bound.y + 2*_palm_radius;
+    if (primary)
+        _estimated_palm_radius = hand.palm_radius;
+    int new_height = hand.hand_center.y-hand_bound.y + 2*hand.palm_radius;
     if (new_height > 0 && new_height < hand_bound.height)
         hand_bound.height = std::move(new_height);
+    hand.hand_bound = hand_bound;
+}
+
+void HandDetector::observe(HandObservation &observation, const int &hand) const
+{
+    if (hand == 0)
+    {
+        observation.tracked_point = _tracked_point;
+        observation.hand_center = _hand_center;
+        observation.hand_bound = _hand_bound;
+        observation.palm_radius = _palm_radius;
+        observation.finger_count = std::min(static_cast<int>(_fingers.size()), HAND_OBSERVATION_MAX_FINGERS);
+        std::copy(_fingers.begin(), _fingers.begin() + observation.finger_count, observation.fingers);
+        std::copy(_finger_ids.begin(), _finger_ids.begin() + observation.finger_count, observation.finger_ids);
+        return;
+    }
+    const auto &h = _hands[hand];
+    observation.tracked_point = h.tracked_point;
+    observation.hand_center = h.hand_center;
+    observation.hand_bound = h.hand_bound;
+    observation.palm_radius = h.palm_radius;
+    observation.finger_count = std::min(static_cast<int>(h.fingers.size()), HAND_OBSERVATION_MAX_FINGERS);
+    std::copy(h.fingers.begin(), h.fingers.begin() + observation.finger_count, observation.fingers);
+    std::fill(observation.finger_ids, observation.finger_ids + observation.finger_count, -1);
+}
+
+cv::Mat HandDetector::extractedImage(const int &hand) const
+{
+    if (hand == 0)
+        return _extracted_img;
+    return _filtered_img(_hands[hand].hand_bound);
+}
+
+int HandDetector::handCount() const
+{
+    return _hand_count;
+}
 
-    _filtered_img(hand_bound).copyTo(_extracted_img);
+cv::Mat HandDetector::filteredImage() const
+{
+    return _filtered_img;
+}
+
+const std::vector<cv::Point> &HandDetector::handContour() const
+{
+    return _hand_contour;
+}
+
+bool HandDetector::waitingBackground() const
+{
+    return _waitting_bg;
+}
+
+qint64 HandDetector::preprocessingTime() const
+{
+    return _preprocessing_us;
+}
+
+qint64 HandDetector::fingerExtractionTime() const
+{
+    return _finger_extraction_us;
+}
 
+void HandDetector::drawConvexity(cv::Mat &img, const cv::Size &size,
+                                 const std::vector<cv::Point> &hand_contour, const HandObservation &observation)
+{
+    img.create(size, CV_8UC3);
+    img.setTo(HandDetector::COLOR_WHITE);
+    if (hand_contour.empty())
+        return;
 
-    cv::drawContours(_convexity_img, contours, indx, HandDetector::COLOR_GRAY, -1);
-    for (const auto & p : _fingers)
+    cv::drawContours(img, std::vector<std::vector<cv::Point> >(1, hand_contour), 0, HandDetector::COLOR_GRAY, -1);
+    for (int i = 0; i < observation.finger_count; ++i)
     {
-        cv::circle(_convexity_img, p, 10, HandDetector::COLOR_RED, 3);
-        cv::line(_convexity_img, p, _hand_center, HandDetector::COLOR_BLUE, 3);
+        cv::circle(img, observation.fingers[i], 10, HandDetector::COLOR_RED, 3);
+        cv::line(img, observation.fingers[i], observation.hand_center, HandDetector::COLOR_BLUE, 3);
     }
-    cv::rectangle(_convexity_img, hand_bound, HandDetector::COLOR_GREEN, 2);
-    cv::circle(_convexity_img, _hand_center, 10, HandDetector::COLOR_RED, -1);
-    cv::circle(_convexity_img, _hand_center, _palm_radius, HandDetector::COLOR_RED, 10);
+    cv::rectangle(img, observation.hand_bound, HandDetector::COLOR_GREEN, 2);
+    cv::circle(img, observation.hand_center, 10, HandDetector::COLOR_RED, -1);
+    cv::circle(img, observation.hand_center, observation.palm_radius, HandDetector::COLOR_RED, 10);
+}
 
-    return true;
+void HandDetector::_fingerTops(Hand &hand) const
+{
+    const auto &contour = hand.polygon;
+    // extract convexity defects
+    cv::convexityDefects(contour, hand.hull, hand.defects);
+    const int n = static_cast<int>(hand.defects.size());
+    auto &b = hand.defect_buffer;
+    auto &farthest_points = hand.farthest_points;
+    farthest_points.clear();
+    b.start_dx.resize(n); b.start_dy.resize(n);
+    b.end_dx.resize(n); b.end_dy.resize(n);
+    b.kept.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        const auto &d = hand.defects[i];
+        b.start_dx[i] = contour[d[0]].x - contour[d[2]].x;
+        b.start_dy[i] = contour[d[0]].y - contour[d[2]].y;
+        b.end_dx[i] = contour[d[1]].x - contour[d[2]].x;
+        b.end_dy[i] = contour[d[1]].y - contour[d[2]].y;
+    }
+    // discard those whose start and end points are too far or too close,
+    // and those from which the angle formed is too small or big, by comparing its squared cosine without any branch
+    for (int i = 0; i < n; ++i)
+    {
+        const int d1 = b.start_dx[i]*b.start_dx[i] + b.start_dy[i]*b.start_dy[i];
+        const int d2 = b.end_dx[i]*b.end_dx[i] + b.end_dy[i]*b.end_dy[i];
+        const int dot = b.start_dx[i]*b.end_dx[i] + b.start_dy[i]*b.end_dy[i];
+        const double dot2 = double(dot)*dot, d12 = double(d1)*d2;
+        b.kept[i] = (d1 >= 100) & (d1 <= 30000) & (d2 >= 100) & (d2 <= 30000)
+                & ((dot <= 0) | (dot2 <= COS2_MIN_FINGER_ANGLE*d12))
+                & ((dot >= 0) | (dot2 <= COS2_MAX_FINGER_ANGLE*d12));
+    }
+    // keep those start or end points who are not too close to those who have been kept
+    hand.grid_cols = _filtered_img.cols/FINGER_MERGE_DISTANCE + 1;
+    hand.finger_cells.assign(hand.grid_cols*(_filtered_img.rows/FINGER_MERGE_DISTANCE + 1), -1);
+    hand.finger_next.clear();
+    for (int i = 0; i < n; ++i)
+    {
+        if (!b.kept[i])
+            continue;
+        const auto &d = hand.defects[i];
+        const bool flag1 = !_nearFinger(hand, contour[d[0]]);
+        const bool flag2 = !_nearFinger(hand, contour[d[1]]);
+        if (flag1)
+        {
+            if (flag2)
+            {
+                if (_squaredEuclidDist<cv::Point, cv::Point>(contour[d[1]], contour[d[0]]) < 1000)
+                {
+                    if (contour[d[0]].y < contour[d[1]].y)
+                        _addFinger(hand, contour[d[0]]);
+                    else
+                        _addFinger(hand, contour[d[1]]);
+                }
+                else
+                {
+                    _addFinger(hand, contour[d[0]]);
+                    _addFinger(hand, contour[d[1]]);
+                }
+            }
+            else
+                _addFinger(hand, contour[d[0]]);
+            farthest_points.push_back(d[2]);
+        }
+        else if (flag2)
+        {
+            _addFinger(hand, contour[d[1]]);
+            farthest_points.push_back(d[2]);
+        }
+    }
+}
+
+bool HandDetector::_nearFinger(const Hand &hand, const cv::Point &p) const
+{
+    const int cx = p.x/FINGER_MERGE_DISTANCE, cy = p.y/FINGER_MERGE_DISTANCE;
+    const int grid_rows = static_cast<int>(hand.finger_cells.size())/hand.grid_cols;
+    for (int y = std::max(0, cy-1); y <= std::min(grid_rows-1, cy+1); ++y)
+        for (int x = std::max(0, cx-1); x <= std::min(hand.grid_cols-1, cx+1); ++x)
+            for (int f = hand.finger_cells[y*hand.grid_cols + x]; f != -1; f = hand.finger_next[f])
+                if (_squaredEuclidDist<cv::Point, cv::Point>(p, hand.fingers[f]) < FINGER_MERGE_DISTANCE*FINGER_MERGE_DISTANCE)
+                    return true;
+    return false;
+}
+
+void HandDetector::_addFinger(Hand &hand, const cv::Point &p) const
+{
+    const int cell = (p.y/FINGER_MERGE_DISTANCE)*hand.grid_cols + p.x/FINGER_MERGE_DISTANCE;
+    hand.finger_next.push_back(hand.finger_cells[cell]);
+    hand.finger_cells[cell] = static_cast<int>(hand.fingers.size());
+    hand.fingers.push_back(p);
 }
 
 template <typename T1, typename T2>
@@ -10,12 +10,20 @@
 #include <opencv2/opencv.hpp>
 
 #include "global.h"
+#include "SkinColorTable.h"
+#include "BinaryMask.h"
+#include "BackgroundModel.h"
+#include "ConnectedComponents.h"
+#include "FingerTracker.h"
+#include "HandObservation.h"
 
 /**
  * @brief The HandDetector class detects hand region and extracts gesture information based on color and morphological features.
  *
  * **ATTENTION**:
  *  This function is not thread-safe.
+ *  The results of a detection are copied by #HandDetector::observe into a record who can be passed to another thread,
+ *  whereas the images and the contour returned by the accessors are those of the detector and are changed by the next detection.
  *
  * This class extracs gesture information by the function #HandDetector::detect
  *
@@ -79,173 +87,162 @@ public:
      * @brief COLOR_BLUE is the blue color in BGR color space
      */
     const static cv::Scalar COLOR_BLUE;
+    explicit HandDetector(QObject *parent = 0);
     /**
-     * @brief interested_img is a reference to #HandDetector::_interesting_img who is a copy of the current input image
+     * @brief detect detects hand and fingers from the given image
      *
-     * @see #HandDetector::_interesting_img
-     */
-    const cv::Mat &interesting_img;
-    /**
-     * @brief filtered_img is the image after preprocessing. This is a reference to #HandDetector::_filtered_img .
+     * The detection process includes
      *
-     * The preprocessing includes
+     *  - image preprocessing
+     *  - finger estimation
+     *  - hand/gesture image extraction
      *
-     *  - background subtraction (if the background is set through #HandDetector::setBackgroundImage),
-     *  - skin color filtering,
-     *  - Gaussian blur,
-     *  - thresholding, and
-     *  - morphological transformation (if it is set through #HandDetector::setMorphology)
+     * If this function return `true`, then the results are obtained by #HandDetector::observe and #HandDetector::extractedImage .
      *
-     * The image obtained is a black-white image.
+     * If the scale set by #HandDetector::setPyramidScale is above 1, the regions of skin color are first located on the image shrunk by the scale.
+     * Only the neighbourhood of those who may reach the detection area is then preprocessed and analyzed at full resolution,
+     * while the rest of #HandDetector::filteredImage is black. The hand and fingers are found in full resolution coordinates
+     * by the same rules, so that the result is unchanged unless a region of skin color is too small to be located on the shrunk image.
      *
-     * @see #HandDetector::_filtered_img
-     * @see #HandDetector::setBackgroundImage
-     * @see #HandDetector::clearBackgroundImage
-     * @see #HandDetector::setDetectionArea
-     * @see #HandDetector::setMorphology
-     * @see #HandDetector::detect
-     */
-    const cv::Mat &filtered_img;
-    /**
-     * @brief convexity_img is the image showing extracted contour region and convexity defects. This is a reference to #HandDetector::_convexity_img .
+     * If tracking is set by #HandDetector::setTracking and the hand was detected in the last frame, only a window around the position predicted
+     * by the last movement of the hand is segmented and analyzed. The window is #DETECTION_TRACKING_MARGIN percent of the hand size larger
+     * than the hand on each side. The whole image is searched instead if no hand is found in the window, if the hand reaches its edge,
+     * or once every #DETECTION_TRACKING_REFRESH frames, such that a larger region of skin color appearing elsewhere is not missed for long.
+     * The window is not used if more than one hand is detected, see #HandDetector::setMaxHands , as the other hands may be anywhere.
      *
-     * A hand region and estimated hand center and finger tops would be drawn on the image.
+     * If more than one hand is detected, the largest regions of at least the detection area are analyzed in parallel,
+     * each in the same way as the single one, except that the finger tops of the others are neither tracked nor predicted.
+     * The regions are chosen by their pixel counts, and then rechecked by the area within their contours, which must be above
+     * the detection area and at most 90% of the image. A region failing the recheck is dropped, and the next one passing it
+     * takes its place, such that nothing is detected only if none passes.
      *
-     * @see #HandDetector::_convexity_img
-     * @see #HandDetector::detect
+     * While tracking, the finger tops are not estimated again if the convex hull of the hand keeps its size within #FINGER_TRACKING_HULL_TOLERANCE ,
+     * but are moved by the velocities of the tracked fingers, for at most #FINGER_TRACKING_REFRESH frames in a row.
+     *
+     * @param input_img : an image
+     * @retval true : if detect something
+     * @retval false : if nothing detected
+     *
+     * @see #HandDetector::observe
+     * @see #HandDetector::filteredImage
+     * @see #HandDetector::detectShared
      */
-    const cv::Mat &convexity_img;
+    bool detect(const cv::Mat &input_img);
     /**
-     * @brief extracted_img is the image of the extracted hand region. This is a reference to #HandDetector::_extracted_img .
+     * @brief detectShared does the same as #HandDetector::detect but reads the given image without copying it.
      *
-     * This image is a black-white image, and only keeps the rectangle area of the hand region.
-     * It may have different size.
+     * The detector then shares the buffer of the given image, which must not be changed until the next detection.
      *
-     * @see #HandDetector::_extracted_img
-     * @see #HandDetector::detect
+     * All the buffers of the detector are kept between calls and only reallocated when the size of the image changes,
+     * so that a detection allocates nothing but inside the OpenCV functions it calls.
+     *
+     * @param input_img : an image
+     * @return if detect something
      */
-    const cv::Mat &extracted_img;
+    bool detectShared(const cv::Mat &input_img);
     /**
-     * @brief background_img is the background image used by the background subtractor.
+     * @brief preprocess performs only the image preprocessing step of #HandDetector::detect on the given image, always on the whole image.
+     *
+     * #HandDetector::filteredImage is updated.
      *
-     * @see #HandDetector::_bg_subtractor
-     * @see #HandDetector::filtered_img
+     * @param input_img : an image
      */
-    const cv::Mat &background_img;
-
+    void preprocess(const cv::Mat &input_img);
     /**
-     * @brief skin_color_lower_bound is the lower bound for the skin color filter in HSV color space.
+     * @brief checkPresence checks cheaply if something of skin color may be in the given image, without any contour analysis.
      *
-     * It is a `cv::Scalar` with three elements representing h, s and v respectively in HSV color space.
+     * The image is shrunk by `scale` and only filtered by the skin color filter and, if the background image is set,
+     * by the difference from the background image. Something is present if the filtered pixels cover at least half of the detection area.
+     * The check errs on the side of presence; call #HandDetector::detect to know if a hand is really there.
      *
-     * @see #HandDetector::filtered_img
-     * @see #HandDetector::setSkinColorFilterLowerBound
-     * @see #HandDetector::skin_color_upper_bound
+     * None of the images or results of #HandDetector::detect is updated.
+     *
+     * @param input_img : an image
+     * @param scale : the factor by which the image is shrunk
+     * @return if something may be present
      */
-    const cv::Scalar &skin_color_lower_bound;
+    bool checkPresence(const cv::Mat &input_img, const int &scale);
     /**
-     * @brief skin_color_lower_bound is the upper bound for the skin color filter in HSV color space.
+     * @brief observe copies the results of the last detection into a record independent of the detector.
      *
-     * It is a `cv::Scalar` with three elements representing h, s and v respectively in HSV color space.
+     * The hand image #HandObservation::crop is left untouched, as it is resized by the #SampleCollector .
+     * Finger tops beyond #HAND_OBSERVATION_MAX_FINGERS are dropped. The finger tops of the hands but the first one have no id, i.e. -1.
      *
-     * @see #HandDetector::filtered_img
-     * @see #HandDetector::setSkinColorFilterUpperBound
-     * @see #HandDetector::skin_color_lower_bound
+     * @param observation : the place where the results will be stored
+     * @param hand : index of the hand, below #HandDetector::handCount
      */
-    const cv::Scalar &skin_color_upper_bound;
-
+    void observe(HandObservation &observation, const int &hand = 0) const;
     /**
-     * @brief morphology is the flag of performing morphology or not during image preprocessing.
+     * @brief extractedImage returns the image of a hand region cut by the palm, i.e. #HandObservation::hand_bound of #HandDetector::filteredImage .
+     *
+     * It is a view of #HandDetector::filteredImage , valid until the next detection; clone it to keep it.
      *
-     * @see #HandDetector::setMorphology
-     * @see #HandDetector::filtered_img
+     * @param hand : index of the hand, below #HandDetector::handCount
      */
-    const bool &morphology;
+    cv::Mat extractedImage(const int &hand = 0) const;
     /**
-     * @brief detection_area is the minimum area of a contour region who will be considered as a hand region.
+     * @brief handCount returns the number of hands found by the last detection, at most the number set by #HandDetector::setMaxHands .
      *
-     * @see #HandDetector::setDetectionArea
+     * The hands are ordered by decreasing area. The finger tops of the first one are tracked.
      */
-    const int &detection_area;
+    int handCount() const;
     /**
-     * @brief tracked_point is point tracked by the detector. This is a reference to #HandDetector::_tracked_point .
+     * @brief filteredImage returns the image after the preprocessing of the last detection, valid until the next detection.
+     *
+     * The preprocessing includes
      *
-     * It is the top most point of the contour region.
+     *  - background subtraction (if the background is set through #HandDetector::setBackgroundImage),
+     *  - skin color filtering,
+     *  - Gaussian blur,
+     *  - thresholding, and
+     *  - morphological transformation (if it is set through #HandDetector::setMorphology)
      *
-     * @see #HandDetector::detect
-     * @see #HandDetector::_tracked_point
+     * The image obtained is a black-white image.
      */
-    const cv::Point &tracked_point;
+    cv::Mat filteredImage() const;
     /**
-     * @brief fingers is a vector containing the finger points detected. This is a reference to #HandDetector::_fingers .
-     *
-     * The estimation is based on convexity defects.
-     * We discard the defect points who are too far, too close, or forming an angle too big or small.
+     * @brief handContour returns the contour of the first hand region, in the coordinates of the input image, valid until the next detection.
      *
-     * @see #HandDetector::_fingers
-     * @see #HandDetector::detect
+     * @see #HandDetector::drawConvexity
      */
-    const std::vector<cv::Point> &fingers;
+    const std::vector<cv::Point> &handContour() const;
     /**
-     * @brief hand_center is the estimated position of hand center. This is a reference to #HandDetector::_hand_center .
+     * @brief waitingBackground returns if the next input image will be set as the background image.
      *
-     * The current estimation scheme is qutie simple. We estimate it as the gravity center of the contour region. It should be very close to the result obtained by distance transformation.
-     *
-     * @see #HandDetector::_hand_center
-     * @see #HandDetector::detect
+     * @see #HandDetector::setBackgroundImage
      */
-    const cv::Point &hand_center;
+    bool waitingBackground() const;
     /**
-     * @brief palm_radius is estimated radius of palm. This is a reference to #HandDetector::_palm_radius .
-     *
-     * @see #HandDetector::_palm_radius
-     * @see #HandDetector::detect
+     * @brief preprocessingTime returns the time, in us, spent on image preprocessing by the last detection.
      */
-    const double &palm_radius;
+    qint64 preprocessingTime() const;
     /**
-     * @brief waitting_bg is a indicator if the system is waitting for setting the background image for the brackground subtractor.
-     *
-     * @see #HandDetector::_bg_subtractor
+     * @brief fingerExtractionTime returns the time, in us, spent on finger estimation and hand image extraction by the last detection.
      */
-    const bool &waitting_bg;
-
-    explicit HandDetector(QObject *parent = 0);
+    qint64 fingerExtractionTime() const;
     /**
-     * @brief detect detects hand and fingers from the given image
-     *
-     * The detection process includes
+     * @brief drawConvexity draws the image showing the hand region, the hand center, the palm and the finger tops found by a detection.
      *
-     *  - image preprocessing
-     *  - finger estimation
-     *  - hand/gesture image extraction
+     * The detector never draws by itself; the image is only drawn for those who show it, from the results of a detection copied beforehand.
      *
-     * If this function return `true`, then the following variables would be updated
-     *
-     *  - #HandDetector::tracked_point
-     *  - #HandDetector::fingers
-     *  - #HandDetector::hand_center
-     *  - #HandDetector::palm_radius
-     *
-     * @param input_img : an image
-     * @retval true : if detect something
-     * @retval false : if nothing detected
-     *
-     * @see #HandDetector::filtered_img
-     * @see #HandDetector::convexity_img
-     * @see #HandDetector::extracted_img
+     * @param img : the place where the image will be stored
+     * @param size : size of the image, i.e. of the input image of the detection
+     * @param hand_contour : #HandDetector::handContour , or an empty contour if nothing was detected
+     * @param observation : the results of the detection obtained by #HandDetector::observe
      */
-    bool detect(const cv::Mat &input_img);
+    static void drawConvexity(cv::Mat &img, const cv::Size &size,
+                              const std::vector<cv::Point> &hand_contour, const HandObservation &observation);
 
 signals:
     /**
      * @brief backgroundImageSet is the signal to indicate a new background image for the background subtractor being set.
-     *        Use #HandDetector::background_img to retrieve the new background image.
+     * @param background : a copy of the new background image, which the detector never changes, such that it can be received by another thread
      *
      * @see #HandDetector::setBackgroundImage
      * @see #HandDetector::backgroundImageCleared
-     * @see #HandDetector::waiting_bg
+     * @see #HandDetector::waitingBackground
      */
-    void backgroundImageSet();
+    void backgroundImageSet(const cv::Mat &background);
     /**
      * @brief backgroundImageCleared is the signal to indicate the background image set for the background subtractor has been cleared.
      *
@@ -259,46 +256,65 @@ public slots:
      * @brief setMorphology sets the flag of performing the morphological transformation.
      * @param perform_morphology : the flag of performing the morphological transformation or not.
      *
-     * @see #HandDetector::filtered_img
-     * @see #HandDetector::morphology
+     * @see #HandDetector::filteredImage
      */
     void setMorphology(const bool & perform_morphology);
     /**
      * @brief setSkinColorFilterLowerBound sets the lower bound for the skin color filter in HSV color space.
+     *        The filter keeps the former bounds for a few frames, until its lookup table of the new bounds is built in the background.
      * @param H : hue in HSV color space, in range 0 to 255
      * @param S : saturation in HSV color space, in range 0 to 255
      * @param V : value in HSV color space, in range 0 to 255
      *
-     * @see #HandDetector::filtered_img
-     * @see #HandDetector::skin_color_lower_bound
+     * @see #HandDetector::filteredImage
      * @see #HandDetector::setSkinColorFilterUpperBound
      */
     void setSkinColorFilterLowerBound(const int & H, const int & S, const int & V);
     /**
      * @brief setSkinColorFilterUpperBound sets the uperer bound for the skin color filter in HSV color space.
+     *        The filter keeps the former bounds for a few frames, until its lookup table of the new bounds is built in the background.
      * @param H : hue in HSV color space, in range 0 to 255
      * @param S : saturation in HSV color space, in range 0 to 255
      * @param V : value in HSV color space, in range 0 to 255
      *
-     * @see #HandDetector::filtered_img
-     * @see #HandDetector::skin_color_upper_bound
+     * @see #HandDetector::filteredImage
      * @see #HandDetector::setSkinColorFilterLowerBound
      */
     void setSkinColorFilterUpperBound(const int & H, const int & S, const int & V);
     /**
-     * @brief setDetectionArea sets the minimum area of a contour region who will be considered as a hand region.
+     * @brief setDetectionArea sets the minimum area, in pixels, of a connected region who will be considered as a hand region.
      * @param area : the minimum area
      *
-     * @see #HandDetector::filtered_img
-     * @see #HandDetector::detection_area
+     * @see #HandDetector::filteredImage
      */
     void setDetectionArea(const int & area);
+    /**
+     * @brief setPyramidScale sets the factor by which the image is shrunk to locate the hand, e.g. 2 or 4.
+     * @param scale : the factor, or 1 to analyze the whole image at full resolution
+     *
+     * @see #HandDetector::detect
+     */
+    void setPyramidScale(const int &scale);
+    /**
+     * @brief setMaxHands sets the maximum number of hands detected in an image, e.g. 2 for commands given by both hands.
+     * @param hands : the number of hands, at least 1
+     *
+     * @see #HandDetector::detect
+     */
+    void setMaxHands(const int &hands);
+    /**
+     * @brief setTracking sets if the hand is searched around where it was in the last frame. It forgets the last position.
+     * @param tracking : the flag to search around the last position or not
+     *
+     * @see #HandDetector::detect
+     */
+    void setTracking(const bool &tracking);
     /**
      * @brief setBackgroundImage indicates the class to set the last input image as the background image for the background subtractor.
      *
-     * @see #HandDetector::filtered_img
+     * @see #HandDetector::filteredImage
      * @see #HandDetector::backgroundImageSet
-     * @see #HandDetector::_bg_subtractor
+     * @see #HandDetector::_background
      * @see #HandDetector::clearBackgroundImage
      */
     void setBackgroundImage();
@@ -306,79 +322,104 @@ public slots:
      * @brief clearBackgroundImage clears the background image for the background subtractor.
      *        No background subtractor will be used after this function is called.
      *
-     * @see #HandDetector::filtered_img
+     * @see #HandDetector::filteredImage
      * @see #HandDetector::backgroundImageCleared
-     * @see #HandDetector::_bg_subtractor
+     * @see #HandDetector::_background
      * @see #HandDetector::setBackgroundImage
      */
     void clearBackgroundImage();
+    /**
+     * @brief setBackgroundLearningRate sets the weight by which the background pixels of each frame are blended into the background image,
+     *        such that slow changes of the lighting are followed.
+     * @param rate : the weight, e.g. 0.01, or 0 to keep the background image as set
+     *
+     * @see #HandDetector::_background
+     */
+    void setBackgroundLearningRate(const double &rate);
 
 protected:
     /**
      * @brief _interested_img is a copy of the current input image
-     *
-     * @see #HandDetector::interesting_img
      */
     cv::Mat _interesting_img;
     /**
      * @brief _filtered_img is is the image after preprocessing.
      *
-     * @see #HandDetector::filtered_img
+     * @see #HandDetector::filteredImage
      */
     cv::Mat _filtered_img;
-    /**
-     * @brief _convexity_img is the image showing extracted contour region and convexity defects.
-     *
-     * @see #HandDetector::convexity_img
-     */
-    cv::Mat _convexity_img;
     /**
      * @brief _extracted_img is the image of the extracted hand region.
      *
-     * @see #HandDetector::extracted_img
+     * @see #HandDetector::extractedImage
      */
     cv::Mat _extracted_img;
     /**
      * @brief _tracked_point is the point suggested for controlling mouse cursor.
      *
-     * @see #HandDetector::tracked_point
+     * @see #HandObservation::tracked_point
      */
     cv::Point _tracked_point;
     /**
      * @brief _fingers is a vector containing the finger top points obtained by the estimation.
      *
-     * @see #HandDetector::fingers
+     * @see #HandObservation::fingers
      */
     std::vector<cv::Point> _fingers;
+    /**
+     * @brief _finger_ids is a vector containing the id of each finger top.
+     *
+     * @see #HandObservation::finger_ids
+     */
+    std::vector<int> _finger_ids;
     /**
      * @brief _hand_center is the estimation of hand center.
      *
-     * @see #HandDetector::hand_center
+     * @see #HandObservation::hand_center
      */
     cv::Point _hand_center;
     /**
      * @brief _palm_radius is the estimation of palm radius.
      *
-     * @see #HandDetector::palm_radius
+     * @see #HandObservation::palm_radius
      */
     double _palm_radius;
     /**
-     * @brief _bg_subtractor is the background subtractor used.
+     * @brief _hand_contour is the contour of the hand region.
      *
-     * @see #HandDetector::waitting_bg
+     * @see #HandDetector::handContour
+     */
+    std::vector<cv::Point> _hand_contour;
+    /**
+     * @brief _hand_bound is the rectangle of the extracted hand region.
+     *
+     * @see #HandObservation::hand_bound
+     */
+    cv::Rect _hand_bound;
+    /**
+     * @brief _background is the background model used as the background subtractor.
+     *
+     * It is not applied on its own but tested by the skin color filter in the same pass.
+     *
+     * @see #HandDetector::waitingBackground
      * @see #HandDetector::setBackgroundImage
      * @see #HandDetector::clearBackgroundImage
      */
-    cv::Ptr<cv::BackgroundSubtractor> _bg_subtractor;
+    BackgroundModel _background;
 
 private:
-    cv::Mat _background_img; // a copy of the initial background image
-    cv::Mat _bg; // used as the mask for subtractor
+    cv::Mat _input_buffer; // the copy of the input image made by detect
     bool _has_set_bg;
     bool _waitting_bg;
 
     cv::Scalar _skin_color_lower_bound;
     cv::Scalar _skin_color_upper_bound;
+    SkinColorTable _skin_table;
+    // the skin mask while it is smoothed and transformed
+    BinaryMask _mask;
+    BinaryMask _mask_buffer;
+    // the masks of each band when preprocessing in parallel
+    std::vector<BinaryMask> _band_masks;
 
     cv::Size _gaussian_size;
     double _gaussian_variance;
@@ -387,11 +428,94 @@ private:
     cv::Mat _morphology_kernel;
 
     int  _detection_area;
+    int _pyramid_scale;
+    int _max_hands;
+    bool _tracking;
+    cv::Rect _search_area;
+    cv::Rect _contour_bound; // bounding box of the hand contour found last
+    cv::Rect _track_bound;
+    cv::Point _track_velocity;
+    int _tracked_frames;
+    FingerTracker _finger_tracker;
+    bool _fingers_predicted; // if the finger tops of the last frame were predicted by the tracker
+    cv::Rect _hull_bound; // bounding box of the hull whose finger tops were estimated last
+    double _hull_area;
+    int _predicted_frames;
+    double _estimated_palm_radius;
 
-    inline void _imagePreprocessing();
-    inline bool _fingerExtraction();
+    qint64 _preprocessing_us;
+    qint64 _finger_extraction_us;
+
+    // buffers of the finger extraction
+    ConnectedComponents _components;
+    // the start and end points of the defects relative to their farthest points, as a structure of arrays
+    struct DefectBuffer
+    {
+        std::vector<int> start_dx;
+        std::vector<int> start_dy;
+        std::vector<int> end_dx;
+        std::vector<int> end_dy;
+        std::vector<uchar> kept;
+    };
+    // the buffers and results of the analysis of one region, such that several regions are analyzed in parallel
+    struct Hand
+    {
+        bool analyzed; // if the region passed the recheck of the area within its contour
+        std::vector<std::vector<cv::Point> > contours;
+        std::vector<cv::Point> polygon;
+        std::vector<int> hull;
+        std::vector<cv::Vec4i> defects;
+        DefectBuffer defect_buffer;
+        // the finger tops in cells of the merging distance, as linked lists of indices of fingers
+        int grid_cols;
+        std::vector<int> finger_cells;
+        std::vector<int> finger_next;
+        std::vector<int> farthest_points;
+        cv::Mat mask;
+        cv::Mat dist_img;
+
+        cv::Rect contour_bound;
+        cv::Point tracked_point;
+        std::vector<cv::Point> fingers;
+        cv::Point hand_center;
+        double palm_radius;
+        cv::Rect hand_bound;
+    };
+    int _hand_count;
+    std::vector<int> _hand_components; // the regions analyzed, by decreasing area
+    std::vector<Hand> _hands;
+
+    // buffers of the presence check
+    cv::Mat _presence_img;
+    cv::Mat _presence_mask;
+
+    // buffers of locating the hand on the shrunk image
+    cv::Mat _coarse_img;
+    cv::Mat _coarse_mask;
+    ConnectedComponents _coarse_components;
+
+    bool _detect(const cv::Mat &input_img, const bool &share);
+    inline void _setInput(const cv::Mat &input_img, const bool &share);
+    void _resetTracking();
+    inline int _filterRadius() const;
+    inline void _subtractBackground();
+    inline const cv::Mat &_backgroundOf(const cv::Size &size);
+    inline bool _locateCandidates(cv::Rect &area);
+    inline void _imagePreprocessing(const cv::Rect &area);
+    typedef void (HandDetector::*BandPreprocessor)(const cv::Rect &, const cv::Mat &, const int &, const int &, BinaryMask &, BinaryMask &);
+    template <bool BACKGROUND, bool MORPHOLOGY>
+    void _preprocessBand(const cv::Rect &area, const cv::Mat &background, const int &top, const int &bottom,
+                         BinaryMask &mask, BinaryMask &buffer);
+    inline bool _fingerExtraction(const cv::Rect &search_area);
+    bool _traceHand(Hand &hand, const int &component);
+    void _analyzeHand(Hand &hand, const bool &primary);
+    void _fingerTops(Hand &hand) const;
+    inline bool _nearFinger(const Hand &hand, const cv::Point &p) const;
+    inline void _addFinger(Hand &hand, const cv::Point &p) const;
     template <typename T1, typename T2>
     inline double _squaredEuclidDist(const T1 &p1, const T2 &p2) const;
 };
 
+Q_DECLARE_METATYPE(cv::Mat)
+
 #endif // HANDDETECTOR_H
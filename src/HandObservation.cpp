@@ -0,0 +1,31 @@
+#include "HandObservation.h"
+#include <atomic>
+
+HandObservationPool::HandObservationPool(const cv::Size &crop_size) :
+    _crop_size(crop_size)
+{}
+
+std::shared_ptr<cv::Mat> HandObservationPool::acquireCrop()
+{
+    for (const auto &crop : _crops)
+    {
+        // only the pool refers to it, and no one else can get a new reference but from the pool
+        if (crop.use_count() == 1)
+        {
+            // pairs with the release of the last reference on another thread, who may have read the image until then
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return crop;
+        }
+    }
+    _crops.push_back(std::make_shared<cv::Mat>(_crop_size, CV_8UC1));
+    return _crops.back();
+}
+
+int HandObservationPool::available() const
+{
+    int n = 0;
+    for (const auto &crop : _crops)
+        if (crop.use_count() == 1)
+            ++n;
+    return n;
+}
@@ -0,0 +1,111 @@
+#ifndef HANDOBSERVATION_H
+#define HANDOBSERVATION_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The HandObservation.h file contains the record of a detected hand passed between threads, and the pool of its hand images.
+ */
+#include <memory>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "global.h"
+
+#ifndef HAND_OBSERVATION_MAX_FINGERS
+/**
+ * @brief HAND_OBSERVATION_MAX_FINGERS is the number of finger tops a #HandObservation can hold. Further finger tops are dropped.
+ */
+#define HAND_OBSERVATION_MAX_FINGERS 10
+#endif
+
+/**
+ * @brief The HandObservation struct is what a detection found about the hand, as a value independent of the #HandDetector .
+ *
+ * The geometry is stored in plain fields, the most used first, and the finger tops in a fixed-size array, such that
+ * the record is copied without any allocation. The hand image is shared by reference counting, so that moving or copying
+ * the record through the queues of #FramePipeline never copies the image.
+ *
+ * It is obtained by #HandDetector::observe , after which the detector may go on with the next image while the record is used by another thread.
+ *
+ * @see #HandObservationPool
+ */
+struct HandObservation
+{
+    /**
+     * @brief tracked_point is the point tracked by the detector, i.e. the top most point of the contour region.
+     */
+    cv::Point tracked_point;
+    /**
+     * @brief hand_center is the estimated position of the hand center, i.e. the point of the hand region farthest from its contour.
+     */
+    cv::Point hand_center;
+    /**
+     * @brief hand_bound is the rectangle of the hand region cut by the palm, i.e. of #HandDetector::extractedImage .
+     */
+    cv::Rect hand_bound;
+    /**
+     * @brief palm_radius is the estimated radius of the palm.
+     */
+    double palm_radius;
+    /**
+     * @brief finger_count is the number of finger tops stored in #HandObservation::fingers .
+     */
+    int finger_count;
+    /**
+     * @brief fingers is the first #HandObservation::finger_count finger tops found.
+     *
+     * The estimation is based on convexity defects.
+     * We discard the defect points who are too far, too close, or forming an angle too big or small.
+     */
+    cv::Point fingers[HAND_OBSERVATION_MAX_FINGERS];
+    /**
+     * @brief finger_ids is the id of each point of #HandObservation::fingers .
+     *
+     * A finger keeps its id across frames as long as its top is found near where its last movement leads, see #FingerTracker .
+     */
+    int finger_ids[HAND_OBSERVATION_MAX_FINGERS];
+    /**
+     * @brief crop is the hand image resized by #SampleCollector::resizeSample , or null if it was not made.
+     *
+     * @see #HandObservationPool::acquireCrop
+     */
+    std::shared_ptr<const cv::Mat> crop;
+
+    HandObservation() : palm_radius(0), finger_count(0) {}
+};
+
+/**
+ * @brief The HandObservationPool class recycles the hand images of #HandObservation .
+ *
+ * The pool keeps a `std::shared_ptr` to each image it made. An image is free again as soon as the last #HandObservation referring to it
+ * is destroyed or reset, whichever thread does it, i.e. when the pool holds the only reference, and is then handed out again by
+ * #HandObservationPool::acquireCrop as a copy of the kept pointer. Neither the images nor the control blocks of the pointers are
+ * allocated but while the number of records in flight grows.
+ *
+ * **ATTENTION**:
+ *  #HandObservationPool::acquireCrop and #HandObservationPool::available must be called by one thread at a time, e.g. only by the thread making the records.
+ *  The content of an image is reused. Do not keep a `cv::Mat` header of it, which does not hold the image, beyond the `std::shared_ptr` .
+ */
+class HandObservationPool
+{
+public:
+    /**
+     * @param crop_size : size of the `CV_8UC1` images
+     */
+    explicit HandObservationPool(const cv::Size &crop_size);
+
+    /**
+     * @brief acquireCrop returns an image who is not referred to by anyone else. Its content is undefined.
+     */
+    std::shared_ptr<cv::Mat> acquireCrop();
+    /**
+     * @brief available returns the number of images in the pool waiting to be reused.
+     */
+    int available() const;
+
+private:
+    const cv::Size _crop_size;
+    std::vector<std::shared_ptr<cv::Mat> > _crops;
+};
+
+#endif // HANDOBSERVATION_H
@@ -0,0 +1,178 @@
+#include "InferenceService.h"
+
+#include <QElapsedTimer>
+
+InferenceService::Client::Client(InferenceService *service) :
+    service(service),
+    sequence(0),
+    // analyzeBatch blocks until its predictions come back, so that one request is in flight at most,
+    // besides the response to one given up when the service stopped
+    requests(2),
+    responses(4)
+{}
+
+int InferenceService::Client::load(const QString &model_file)
+{
+    return service->_load(model_file);
+}
+
+std::vector<InferenceService::Prediction> InferenceService::Client::analyze(const cv::Mat &img, const int &get_N)
+{
+    auto res = analyzeBatch(std::vector<cv::Mat>(1, img), get_N);
+    return res.empty() ? std::vector<Prediction>() : std::move(res.front());
+}
+
+std::vector<std::vector<InferenceService::Prediction> > InferenceService::Client::analyzeBatch(const std::vector<cv::Mat> &imgs, const int &get_N)
+{
+    if (imgs.empty() || !service->isRunning())
+        return std::vector<std::vector<Prediction> >();
+    requests.push(Request{++sequence, imgs, get_N});
+    service->_pending.release();
+    Response res;
+    while (true)
+    {
+        if (!done.tryAcquire(1, 100))
+        {
+            // the service was stopped before serving the request, whose response, if any, is dropped by the next call
+            if (!service->isRunning())
+                return std::vector<std::vector<Prediction> >();
+            continue;
+        }
+        responses.pop(res);
+        if (res.sequence == sequence)
+            return std::move(res.predictions);
+    }
+}
+
+InferenceService::InferenceService(GestureAnalystInterface *analyst, QObject *parent) :
+    QThread(parent),
+    _analyst(analyst),
+    _stopping(false),
+    _next_client(0),
+    _loaded_labels(-1),
+    _forward_passes(0),
+    _analyzed_images(0)
+{}
+
+InferenceService::~InferenceService()
+{
+    stop();
+    for (auto c : _clients)
+        delete c;
+}
+
+GestureAnalystInterface *InferenceService::createClient()
+{
+    _clients.push_back(new Client(this));
+    return _clients.back();
+}
+
+void InferenceService::stop()
+{
+    _stopping = true;
+    wait();
+    _stopping = false;
+}
+
+quint64 InferenceService::forwardPasses() const
+{
+    return _forward_passes;
+}
+
+quint64 InferenceService::analyzedImages() const
+{
+    return _analyzed_images;
+}
+
+void InferenceService::run()
+{
+    const int streams = static_cast<int>(_clients.size());
+    std::vector<Client *> batch_clients;
+    std::vector<cv::Mat> batch_imgs;
+    while (!_stopping)
+    {
+        if (!_pending.tryAcquire(1, 100))
+            continue;
+        int n = 1;
+        // give the other streams a moment to queue their images into the same batch
+        QElapsedTimer window;
+        window.start();
+        while (n < streams && n < INFERENCE_MAX_BATCH)
+        {
+            if (_pending.tryAcquire())
+                ++n;
+            else if (window.nsecsElapsed()/1000 >= INFERENCE_BATCH_WINDOW)
+                break;
+            else
+                QThread::usleep(50);
+        }
+
+        // take the requests round-robin such that no stream is always served last
+        batch_clients.clear();
+        batch_imgs.clear();
+        int get_N = 1;
+        std::vector<quint64> sequences;
+        std::vector<int> requested_N;
+        std::vector<int> first_imgs;
+        while (static_cast<int>(batch_clients.size()) < n)
+        {
+            auto client = _clients[_next_client];
+            _next_client = (_next_client + 1) % _clients.size();
+            Request r;
+            if (!client->requests.pop(r))
+                continue;
+            batch_clients.push_back(client);
+            sequences.push_back(r.sequence);
+            first_imgs.push_back(static_cast<int>(batch_imgs.size()));
+            batch_imgs.insert(batch_imgs.end(), r.imgs.begin(), r.imgs.end());
+            requested_N.push_back(r.get_N);
+            if (r.get_N > get_N)
+                get_N = r.get_N;
+        }
+        first_imgs.push_back(static_cast<int>(batch_imgs.size()));
+
+        auto res = _analyst->analyzeBatch(batch_imgs, get_N);
+        ++_forward_passes;
+        _analyzed_images += batch_imgs.size();
+        for (int i = 0; i < n; ++i)
+        {
+            std::vector<std::vector<Prediction> > p;
+            if (static_cast<int>(res.size()) >= first_imgs[i+1])
+            {
+                for (int k = first_imgs[i]; k < first_imgs[i+1]; ++k)
+                {
+                    if (static_cast<int>(res[k].size()) > requested_N[i])
+                        res[k].erase(res[k].begin() + requested_N[i], res[k].end());
+                    p.push_back(std::move(res[k]));
+                }
+            }
+            _respond(batch_clients[i], sequences[i], std::move(p));
+        }
+    }
+    // answer the requests left such that no stream waits forever
+    for (auto c : _clients)
+    {
+        Request r;
+        while (c->requests.pop(r))
+            _respond(c, r.sequence, std::vector<std::vector<Prediction> >());
+    }
+    while (_pending.tryAcquire())
+    {}
+}
+
+int InferenceService::_load(const QString &model_file)
+{
+    QMutexLocker locker(&_load_mutex);
+    if (_loaded_labels < 0 || model_file != _loaded_model)
+    {
+        _loaded_labels = _analyst->load(model_file);
+        _loaded_model = model_file;
+    }
+    return _loaded_labels;
+}
+
+void InferenceService::_respond(Client *client, const quint64 &sequence, std::vector<std::vector<Prediction> > &&predictions)
+{
+    client->responses.push(Response{sequence, std::move(predictions)});
+    client->done.release();
+}
@@ -0,0 +1,127 @@
+#ifndef INFERENCESERVICE_H
+#define INFERENCESERVICE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The InferenceService.h file contains the thread who serves the inference of several streams with one network and batches their hand images.
+ */
+#include <atomic>
+#include <vector>
+#include <QThread>
+#include <QSemaphore>
+#include <QMutex>
+#include <QString>
+#include <opencv2/opencv.hpp>
+
+#include "SpscQueue.h"
+#include "GestureAnalystInterface.h"
+
+#ifndef INFERENCE_MAX_BATCH
+/**
+ * @brief INFERENCE_MAX_BATCH is the maximum number of requests analyzed in one forward pass by #InferenceService , each of one hand image unless it comes from #GestureAnalystInterface::analyzeBatch .
+ */
+#define INFERENCE_MAX_BATCH 16
+#endif
+#ifndef INFERENCE_BATCH_WINDOW
+/**
+ * @brief INFERENCE_BATCH_WINDOW is the time, in us, #InferenceService waits for the other streams after the first image of a batch arrived.
+ */
+#define INFERENCE_BATCH_WINDOW 1000
+#endif
+
+/**
+ * @brief The InferenceService class runs one #GestureAnalystInterface, e.g. one network, for several streams in its own thread.
+ *
+ * Each stream gets a client by #InferenceService::createClient , which is a #GestureAnalystInterface and can be given to the stream's #FramePipeline
+ * in place of its own analyst. The inference stage of each stream calls #GestureAnalystInterface::analyze on its client as before;
+ * the call puts the image into the client's queue and blocks until the prediction comes back.
+ * #GestureAnalystInterface::analyzeBatch on a client, e.g. for the hands of one frame, queues all its images as one request.
+ * The service collects the images queued by all streams, waiting at most #INFERENCE_BATCH_WINDOW us for the streams who have not queued one yet,
+ * analyzes them by one call of #GestureAnalystInterface::analyzeBatch , and routes each result back to its client.
+ *
+ * The model is loaded once for all streams: #GestureAnalystInterface::load on a client only loads the model if it differs from the loaded one.
+ *
+ * **ATTENTION**:
+ *  Create all clients before #InferenceService::start , and stop the pipelines using the clients before #InferenceService::stop .
+ */
+class InferenceService : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+     * @param analyst : the analyst shared by all streams. It is not owned by the service.
+     * @param parent : parent object
+     */
+    explicit InferenceService(GestureAnalystInterface *analyst, QObject *parent = 0);
+    ~InferenceService();
+
+    /**
+     * @brief createClient creates the analyst for a new stream. It is owned by the service.
+     */
+    GestureAnalystInterface *createClient();
+    /**
+     * @brief stop stops the service thread. Requests in flight get no prediction.
+     */
+    void stop();
+    /**
+     * @brief forwardPasses returns the number of batches analyzed so far.
+     */
+    quint64 forwardPasses() const;
+    /**
+     * @brief analyzedImages returns the number of images analyzed so far.
+     */
+    quint64 analyzedImages() const;
+
+protected:
+    void run() override;
+
+private:
+    typedef GestureAnalystInterface::Prediction Prediction;
+
+    // the requests and responses of a client carry the same sequence number, such that
+    // a response to a request given up when the service stopped is never taken for the next one
+    struct Request
+    {
+        quint64 sequence;
+        std::vector<cv::Mat> imgs;
+        int get_N;
+    };
+    struct Response
+    {
+        quint64 sequence;
+        std::vector<std::vector<Prediction> > predictions;
+    };
+
+    class Client : public GestureAnalystInterface
+    {
+    public:
+        explicit Client(InferenceService *service);
+        int load(const QString &model_file) override;
+        std::vector<Prediction> analyze(const cv::Mat &img, const int &get_N) override;
+        std::vector<std::vector<Prediction> > analyzeBatch(const std::vector<cv::Mat> &imgs, const int &get_N) override;
+
+        InferenceService *service;
+        quint64 sequence;
+        SpscQueue<Request> requests;
+        SpscQueue<Response> responses;
+        QSemaphore done;
+    };
+
+    int _load(const QString &model_file);
+    void _respond(Client *client, const quint64 &sequence, std::vector<std::vector<Prediction> > &&predictions);
+
+    GestureAnalystInterface *_analyst;
+    std::vector<Client *> _clients;
+    QSemaphore _pending;
+    std::atomic<bool> _stopping;
+    std::size_t _next_client;
+
+    QMutex _load_mutex;
+    QString _loaded_model;
+    int _loaded_labels;
+
+    std::atomic<quint64> _forward_passes;
+    std::atomic<quint64> _analyzed_images;
+};
+
+#endif // INFERENCESERVICE_H
@@ -0,0 +1,97 @@
+#include "LatencyHistogram.h"
+
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::record(const qint64 &us)
+{
+    const quint64 value = us > 0 ? static_cast<quint64>(us) : 0;
+    _counts[_bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(value, std::memory_order_relaxed);
+    auto max = _max.load(std::memory_order_relaxed);
+    while (static_cast<qint64>(value) > max &&
+           !_max.compare_exchange_weak(max, static_cast<qint64>(value), std::memory_order_relaxed))
+    {}
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &c : _counts)
+        c.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+qint64 LatencyHistogram::percentile(const double &p) const
+{
+    quint64 counts[BUCKETS];
+    quint64 total = 0;
+    for (int i = 0; i < BUCKETS; ++i)
+        total += (counts[i] = _counts[i].load(std::memory_order_relaxed));
+    return _percentileOf(counts, total, p, _max.load(std::memory_order_relaxed));
+}
+
+LatencyHistogram::Summary LatencyHistogram::summary() const
+{
+    // take one snapshot such that the statistics are consistent with each other
+    quint64 counts[BUCKETS];
+    quint64 total = 0;
+    for (int i = 0; i < BUCKETS; ++i)
+        total += (counts[i] = _counts[i].load(std::memory_order_relaxed));
+
+    Summary s;
+    s.count = total;
+    s.max = _max.load(std::memory_order_relaxed);
+    s.mean = total == 0 ? 0.0 : static_cast<double>(_sum.load(std::memory_order_relaxed))/total;
+    s.p50 = _percentileOf(counts, total, 50, s.max);
+    s.p95 = _percentileOf(counts, total, 95, s.max);
+    s.p99 = _percentileOf(counts, total, 99, s.max);
+    return s;
+}
+
+qint64 LatencyHistogram::_percentileOf(const quint64 (&counts)[BUCKETS], const quint64 &total, const double &p, const qint64 &max) const
+{
+    if (total == 0)
+        return 0;
+    auto rank = static_cast<quint64>(std::ceil(total*p/100));
+    if (rank < 1)
+        rank = 1;
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKETS; ++i)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+        {
+            const auto v = _highestOf(i);
+            return v < max ? v : max;
+        }
+    }
+    return max;
+}
+
+int LatencyHistogram::_bucketOf(const quint64 &value)
+{
+    if (value < 2*SUB_BUCKETS)
+        return static_cast<int>(value);
+    if (value >> MAX_VALUE_BITS)
+        return BUCKETS - 1;
+    int msb = 0;
+    for (auto v = value; v > 1; v >>= 1)
+        ++msb;
+    const int shift = msb - SUB_BUCKET_BITS;
+    // the top SUB_BUCKET_BITS+1 bits of the value, i.e. [SUB_BUCKETS, 2*SUB_BUCKETS)
+    return shift*SUB_BUCKETS + static_cast<int>(value >> shift);
+}
+
+qint64 LatencyHistogram::_highestOf(const int &bucket)
+{
+    if (bucket < 2*SUB_BUCKETS)
+        return bucket;
+    const int shift = bucket/SUB_BUCKETS - 1;
+    const qint64 sub = bucket - shift*SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
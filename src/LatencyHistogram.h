@@ -0,0 +1,101 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The LatencyHistogram.h file contains a lock-free histogram of latencies with a bounded relative error.
+ */
+#include <atomic>
+#include <QtGlobal>
+
+/**
+ * @brief The LatencyHistogram class records latencies, in us, into log-linear buckets in the way of HdrHistogram.
+ *
+ * Values below 64 us are counted exactly. Above that, each power of two is split into 32 linear buckets,
+ * such that a percentile is reported with a relative error below 1/32. Values up to about 12 days are recorded;
+ * larger ones are counted into the last bucket.
+ *
+ * **ATTENTION**:
+ *  #LatencyHistogram::record can be called from any thread without locking. A summary read while others are recording
+ *  may miss the samples in flight, but is never corrupted.
+ */
+class LatencyHistogram
+{
+public:
+    /**
+     * @brief Summary is a snapshot of the statistics of a histogram.
+     */
+    struct Summary
+    {
+        /**
+         * @brief count is the number of samples.
+         */
+        quint64 count;
+        /**
+         * @brief mean is the mean of the samples in us.
+         */
+        double mean;
+        /**
+         * @brief p50 is the median in us.
+         */
+        qint64 p50;
+        /**
+         * @brief p95 is the 95th percentile in us.
+         */
+        qint64 p95;
+        /**
+         * @brief p99 is the 99th percentile in us.
+         */
+        qint64 p99;
+        /**
+         * @brief max is the maximum sample in us. It is exact.
+         */
+        qint64 max;
+    };
+
+    LatencyHistogram();
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    /**
+     * @brief record records a sample. Negative samples are recorded as 0.
+     */
+    void record(const qint64 &us);
+    /**
+     * @brief reset drops all samples.
+     */
+    void reset();
+    /**
+     * @brief percentile returns the smallest value, in us, which is not less than `p` percent of the samples, or 0 if there is no sample.
+     * @param p : a percent in [0, 100]
+     */
+    qint64 percentile(const double &p) const;
+    /**
+     * @brief summary returns the count, mean, median, 95th and 99th percentiles and maximum of the samples.
+     */
+    Summary summary() const;
+
+protected:
+    static const int SUB_BUCKET_BITS = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_VALUE_BITS = 40;
+    static const int BUCKETS = (MAX_VALUE_BITS - 1 - SUB_BUCKET_BITS)*SUB_BUCKETS + 2*SUB_BUCKETS;
+
+    /**
+     * @brief _bucketOf returns the index of the bucket into which the given value falls.
+     */
+    static int _bucketOf(const quint64 &value);
+    /**
+     * @brief _highestOf returns the largest value who falls into the given bucket.
+     */
+    static qint64 _highestOf(const int &bucket);
+
+private:
+    std::atomic<quint64> _counts[BUCKETS];
+    std::atomic<quint64> _sum;
+    std::atomic<qint64> _max;
+
+    qint64 _percentileOf(const quint64 (&counts)[BUCKETS], const quint64 &total, const double &p, const qint64 &max) const;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -1,5 +1,10 @@
 #include "MonitorView.h"
 
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QDir>
+
 MonitorView *MonitorView::getInstance()
 {
     return Singleton<MonitorView>::instance(MonitorView::createInstance);
@@ -21,18 +26,43 @@ MonitorView::MonitorView(QWidget *parent) : QDialog(parent)
     _ui_lbl_image3->setAlignment(Qt::AlignCenter);
     _ui_lbl_text->setAlignment(Qt::AlignLeft | Qt::AlignTop);
 
+    _ui_tbl_latency = new QTableWidget(StageProfiler::STAGE_COUNT, 5);
+    _ui_tbl_latency->setHorizontalHeaderLabels(QStringList() << tr("Count") << tr("p50 us") << tr("p95 us") << tr("p99 us") << tr("Max us"));
+    for (int i = 0; i < StageProfiler::STAGE_COUNT; ++i)
+    {
+        _ui_tbl_latency->setVerticalHeaderItem(i, new QTableWidgetItem(StageProfiler::stageName(static_cast<StageProfiler::STAGE>(i))));
+        for (int j = 0; j < 5; ++j)
+        {
+            auto item = new QTableWidgetItem;
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            _ui_tbl_latency->setItem(i, j, item);
+        }
+    }
+    _ui_tbl_latency->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _ui_tbl_latency->setSelectionMode(QAbstractItemView::NoSelection);
+    _ui_tbl_latency->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    _ui_btn_dump_latency = new QPushButton(tr("Dump CSV"));
+
+    QVBoxLayout * info_layout = new QVBoxLayout;
+    info_layout->setContentsMargins(0, 0, 0, 0);
+    info_layout->addWidget(_ui_lbl_text);
+    info_layout->addWidget(_ui_tbl_latency, 1);
+    info_layout->addWidget(_ui_btn_dump_latency, 0, Qt::AlignRight);
+
     QGridLayout * main_layout = new QGridLayout;
     main_layout->setContentsMargins(10, 10, 10, 10);
     main_layout->setSpacing(10);
     main_layout->addWidget(_ui_lbl_image1, 0, 0, 1, 1);
     main_layout->addWidget(_ui_lbl_image2, 0, 1, 1, 1);
     main_layout->addWidget(_ui_lbl_image3, 1, 0, 1, 1);
-    main_layout->addWidget(_ui_lbl_text, 1, 1, 1, 1);
+    main_layout->addLayout(info_layout, 1, 1, 1, 1);
 
     setLayout(main_layout);
     setWindowTitle(tr("Monitor"));
-    resize(380, 290);
+    resize(640, 480);
     setMinimumSize(200, 200);
+
+    connect(_ui_btn_dump_latency, SIGNAL(released()), this, SLOT(_uiBtnDumpLatencyReleased()));
 }
 
 void MonitorView::updateMonitorImage3(const QPixmap &image1,
@@ -76,6 +106,28 @@ void MonitorView::setMsg(const QString &text)
     _ui_lbl_text->setText(text);
 }
 
+void MonitorView::updateLatency(const StageProfiler &profiler)
+{
+    for (int i = 0; i < StageProfiler::STAGE_COUNT; ++i)
+    {
+        const auto s = profiler.histogram(static_cast<StageProfiler::STAGE>(i)).summary();
+        _ui_tbl_latency->item(i, 0)->setText(QString::number(s.count));
+        _ui_tbl_latency->item(i, 1)->setText(QString::number(s.p50));
+        _ui_tbl_latency->item(i, 2)->setText(QString::number(s.p95));
+        _ui_tbl_latency->item(i, 3)->setText(QString::number(s.p99));
+        _ui_tbl_latency->item(i, 4)->setText(QString::number(s.max));
+    }
+}
+
+void MonitorView::_uiBtnDumpLatencyReleased()
+{
+    QString file = QFileDialog::getSaveFileName(this, tr("Dump Latency"),
+                                                QDir::home().filePath("latency.csv"),
+                                                tr("CSV Files (*.csv)"), Q_NULLPTR, QFileDialog::DontUseNativeDialog);
+    if (!file.isEmpty())
+        emit latencyDumpRequest(file);
+}
+
 void MonitorView::closeEvent(QCloseEvent * e)
 {
     _ui_lbl_image1->clear();
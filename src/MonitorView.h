@@ -11,15 +11,18 @@
 #include <QLabel>
 #include <QGridLayout>
 #include <QCloseEvent>
+#include <QTableWidget>
+#include <QPushButton>
 
 #include "Singleton.h"
+#include "StageProfiler.h"
 
 /**
  * @brief The MonitorView class provides the GUI of the monitor window
  *
  * The monitor window will displays three images as the monitor. \n
  * The three images will be displayed on the left-top, right-top and left-bottom region of the window.\n
- * The right-bottom region is used to display text information.
+ * The right-bottom region is used to display text information, the latency table of the stages and a button to dump the table into a CSV file.
  *
  * This is a singleton class. Use #Monitor::getInstance() to get the instance of this class.
  */
@@ -56,6 +59,23 @@ public:
      * @param text : text that will be shown
      */
     void setMsg(const QString &text);
+    /**
+     * @brief updateLatency shows the count, median, 95th and 99th percentiles and maximum latency of each stage.
+     * @param profiler : the profiler whose histograms will be shown
+     */
+    void updateLatency(const StageProfiler &profiler);
+
+signals:
+    /**
+     * @brief latencyDumpRequest is the signal of the request for dumping the latency of each stage into a CSV file.
+     * @param file : path of the CSV file
+     *
+     * @see #StageProfiler::writeCsv
+     */
+    void latencyDumpRequest(const QString &file);
+
+private slots:
+    void _uiBtnDumpLatencyReleased();
 
 private:
     explicit MonitorView(QWidget *parent = 0);
@@ -69,6 +89,8 @@ private:
     QLabel * _ui_lbl_image2;
     QLabel * _ui_lbl_image3;
     QLabel * _ui_lbl_text;
+    QTableWidget * _ui_tbl_latency;
+    QPushButton * _ui_btn_dump_latency;
 
 };
 
@@ -24,6 +24,11 @@ Settings::Settings(QObject * parent) :
     skin_color_max_V(_skin_color_max_V),
     skin_detection_area(_skin_detection_area),
     skin_morphology(_skin_morpology),
+    detection_pyramid_scale(_detection_pyramid_scale),
+    detection_max_hands(_detection_max_hands),
+    detection_tracking(_detection_tracking),
+    background_learning_rate(_background_learning_rate),
+    standby_timeout(_standby_timeout),
     sampling_amount_per_time(_sampling_amount_per_time),
     sampling_interval(_sampling_interval),
     gesture_selected(_gesture_selected),
@@ -46,6 +51,11 @@ Settings::Settings(QObject * parent) :
     _skin_color_max_V = _settings->value("skin-color-max-V", DEFAULT_SKIN_COLOR_MAX_V).toInt();
     _skin_detection_area = _settings->value("skin-detection-area", DEFAULT_SKIN_DETECTION_AREA).toInt();
     _skin_morpology = _settings->value("skin-morphology", DEFAULT_SKIN_MORPHOLOGY).toBool();
+    _detection_pyramid_scale = _settings->value("detection-pyramid-scale", DEFAULT_DETECTION_PYRAMID_SCALE).toInt();
+    _detection_max_hands = _settings->value("detection-max-hands", DEFAULT_DETECTION_MAX_HANDS).toInt();
+    _detection_tracking = _settings->value("detection-tracking", DEFAULT_DETECTION_TRACKING).toBool();
+    _background_learning_rate = _settings->value("background-learning-rate", DEFAULT_BACKGROUND_LEARNING_RATE).toDouble();
+    _standby_timeout = _settings->value("standby-timeout", DEFAULT_STANDBY_TIMEOUT).toInt();
 
     _sampling_amount_per_time = _settings->value("sampling-amount-per-time", DEFAULT_SAMPLING_AMOUNT_PER_TIME).toInt();
     _sampling_interval = _settings->value("sampling-interval", DEFAULT_SAMPLING_INTERVAL).toInt();
@@ -137,6 +147,36 @@ void Settings::setSkinMorphology(const bool &perform_morphology)
     _settings->setValue("skin-morphology", perform_morphology);
 }
 
+void Settings::setDetectionPyramidScale(const int &scale)
+{
+    _detection_pyramid_scale = scale;
+    _settings->setValue("detection-pyramid-scale", scale);
+}
+
+void Settings::setDetectionMaxHands(const int &hands)
+{
+    _detection_max_hands = hands;
+    _settings->setValue("detection-max-hands", hands);
+}
+
+void Settings::setDetectionTracking(const bool &tracking)
+{
+    _detection_tracking = tracking;
+    _settings->setValue("detection-tracking", tracking);
+}
+
+void Settings::setBackgroundLearningRate(const double &rate)
+{
+    _background_learning_rate = rate;
+    _settings->setValue("background-learning-rate", rate);
+}
+
+void Settings::setStandbyTimeout(const int &ms)
+{
+    _standby_timeout = ms;
+    _settings->setValue("standby-timeout", ms);
+}
+
 void Settings::setSamplingAmountPerTime(const int &amount)
 {
     _sampling_amount_per_time = amount;
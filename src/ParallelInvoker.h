@@ -0,0 +1,39 @@
+#ifndef PARALLELINVOKER_H
+#define PARALLELINVOKER_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The ParallelInvoker.h file contains the adapter who runs a lambda on the thread pool of OpenCV.
+ */
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief The ParallelInvoker class wraps a callable taking a `cv::Range` into a `cv::ParallelLoopBody` .
+ *
+ * `cv::parallel_for_` splits the range into stripes and schedules them on the thread pool of OpenCV,
+ * e.g. the work-stealing scheduler of TBB if OpenCV is built with it. A stripe running inside another one runs on the calling thread.
+ */
+template <typename Function>
+class ParallelInvoker : public cv::ParallelLoopBody
+{
+public:
+    explicit ParallelInvoker(const Function &function) : _function(function) {}
+    void operator()(const cv::Range &range) const override { _function(range); }
+
+private:
+    const Function &_function;
+};
+
+/**
+ * @brief parallelFor runs the callable on stripes of the range in parallel.
+ * @param range : the range split
+ * @param function : a callable taking the `cv::Range` of a stripe
+ * @param stripes : the number of stripes the range is split into at most
+ */
+template <typename Function>
+void parallelFor(const cv::Range &range, const Function &function, const int &stripes)
+{
+    cv::parallel_for_(range, ParallelInvoker<Function>(function), stripes);
+}
+
+#endif // PARALLELINVOKER_H
@@ -0,0 +1,205 @@
+#include "ReplaySource.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QThread>
+
+ReplaySource::ReplaySource(const QString &path, const bool &realtime, const double &fps) :
+    ReplaySource(path, formatOf(path), realtime, fps)
+{}
+
+ReplaySource::ReplaySource(const QString &path, const REPLAY_FORMAT &format, const bool &realtime, const double &fps) :
+    path(_path),
+    format(_format),
+    fps(_fps),
+    _path(path),
+    _format(format),
+    _realtime(realtime),
+    _fps(fps > 0 ? fps : CAMERA_FPS),
+    _opened(false),
+    _at_end(false),
+    _index(0),
+    _peeked_timestamp(0),
+    _first_timestamp(0)
+{}
+
+ReplaySource::REPLAY_FORMAT ReplaySource::formatOf(const QString &path)
+{
+    QFileInfo info(path);
+    if (info.isDir())
+        return FORMAT_IMAGE_DIRECTORY;
+    if (info.suffix().compare("rawframes", Qt::CaseInsensitive) == 0)
+        return FORMAT_RAW_DUMP;
+    return FORMAT_VIDEO;
+}
+
+bool ReplaySource::open()
+{
+    if (_opened)
+        return true;
+    _at_end = false;
+    _index = 0;
+    if (_format == FORMAT_VIDEO)
+    {
+        if (!_video.open(_path.toStdString()))
+            return false;
+        auto video_fps = _video.get(cv::CAP_PROP_FPS);
+        if (video_fps > 0)
+            _fps = video_fps;
+    }
+    else if (_format == FORMAT_IMAGE_DIRECTORY)
+    {
+        _images = QDir(_path).entryList(QStringList() << "*.pgm" << "*.PGM" << "*.png" << "*.PNG",
+                                        QDir::Files, QDir::Name);
+        if (_images.empty())
+            return false;
+    }
+    else
+    {
+        _raw.setFileName(_path);
+        if (!_raw.open(QIODevice::ReadOnly))
+            return false;
+    }
+    _opened = true;
+    // peek the first frame to know the frame size before the pipeline starts
+    if (!_readNext(_peeked_frame, _peeked_timestamp))
+    {
+        release();
+        return false;
+    }
+    _frame_size = _peeked_frame.size();
+    return true;
+}
+
+bool ReplaySource::isOpened() const
+{
+    return _opened;
+}
+
+void ReplaySource::release()
+{
+    _video.release();
+    _images.clear();
+    _raw.close();
+    _peeked_frame.release();
+    _clock.invalidate();
+    _opened = false;
+}
+
+bool ReplaySource::read(cv::Mat &frame)
+{
+    if (!_opened)
+        return false;
+    qint64 timestamp;
+    if (!_peeked_frame.empty())
+    {
+        frame = _peeked_frame;
+        timestamp = _peeked_timestamp;
+        _peeked_frame = cv::Mat();
+    }
+    else if (!_readNext(frame, timestamp))
+        return false;
+    _wait(timestamp);
+    return true;
+}
+
+bool ReplaySource::atEnd() const
+{
+    return _at_end;
+}
+
+bool ReplaySource::isLive() const
+{
+    return false;
+}
+
+cv::Size ReplaySource::frameSize() const
+{
+    return _frame_size;
+}
+
+bool ReplaySource::writeRawFrame(QFile &file, const cv::Mat &frame, const qint64 &timestamp)
+{
+    if (frame.empty() || (frame.type() != CV_8UC3 && frame.type() != CV_8UC1))
+        return false;
+    RawFrameHeader header;
+    header.magic = RAW_FRAME_MAGIC;
+    header.width = frame.cols;
+    header.height = frame.rows;
+    header.type = frame.type();
+    header.timestamp = timestamp;
+    if (file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header))
+        return false;
+    const qint64 row_size = frame.cols*frame.elemSize();
+    for (int r = 0; r < frame.rows; ++r)
+        if (file.write(frame.ptr<char>(r), row_size) != row_size)
+            return false;
+    return true;
+}
+
+bool ReplaySource::_readNext(cv::Mat &frame, qint64 &timestamp)
+{
+    if (_format == FORMAT_VIDEO)
+    {
+        if (!_video.read(frame) || frame.empty())
+        {
+            _at_end = true;
+            return false;
+        }
+    }
+    else if (_format == FORMAT_IMAGE_DIRECTORY)
+    {
+        if (_index >= static_cast<quint64>(_images.size()))
+        {
+            _at_end = true;
+            return false;
+        }
+        frame = cv::imread(QDir(_path).filePath(_images.at(_index)).toStdString(), cv::IMREAD_COLOR);
+        // an unreadable image is an error rather than the end of the recording
+        if (frame.empty())
+            return false;
+    }
+    else
+    {
+        RawFrameHeader header;
+        const auto read = _raw.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (read == 0)
+        {
+            _at_end = true;
+            return false;
+        }
+        if (read != sizeof(header) || header.magic != RAW_FRAME_MAGIC ||
+                header.width <= 0 || header.height <= 0 ||
+                (header.type != CV_8UC3 && header.type != CV_8UC1))
+            return false;
+        cv::Mat raw(header.height, header.width, header.type);
+        const qint64 size = raw.total()*raw.elemSize();
+        if (_raw.read(reinterpret_cast<char *>(raw.data), size) != size)
+            return false;
+        if (raw.channels() == 1)
+            cv::cvtColor(raw, frame, cv::COLOR_GRAY2BGR);
+        else
+            frame = raw;
+        timestamp = header.timestamp;
+        ++_index;
+        return true;
+    }
+    timestamp = static_cast<qint64>(_index*1000000/_fps);
+    ++_index;
+    return true;
+}
+
+void ReplaySource::_wait(const qint64 &timestamp)
+{
+    if (!_realtime)
+        return;
+    if (!_clock.isValid())
+    {
+        _clock.start();
+        _first_timestamp = timestamp;
+        return;
+    }
+    const auto ahead = timestamp - _first_timestamp - _clock.nsecsElapsed()/1000;
+    if (ahead > 0)
+        QThread::usleep(static_cast<unsigned long>(ahead));
+}
@@ -0,0 +1,145 @@
+#ifndef REPLAYSOURCE_H
+#define REPLAYSOURCE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The ReplaySource.h file contains the frame source who replays recorded video files, image sequences or raw frame dumps.
+ */
+#include <QString>
+#include <QStringList>
+#include <QFile>
+#include <QElapsedTimer>
+#include <opencv2/opencv.hpp>
+
+#include "global.h"
+#include "FrameSourceInterface.h"
+
+/**
+ * @brief The ReplaySource class replays a recording as a frame source.
+ *
+ * Three kinds of recordings are supported:
+ *
+ *  - a video file readable by `cv::VideoCapture`,
+ *  - a directory of `PGM` or `PNG` images, replayed in the order of their file names, and
+ *  - a raw frame dump, a file whose name ends with `.rawframes`. It is a sequence of records, each of which is
+ *    a #ReplaySource::RawFrameHeader followed by `height` rows of `width * CV_ELEM_SIZE(type)` bytes. See #ReplaySource::writeRawFrame .
+ *
+ * Frames are replayed either at the recorded timing or as fast as the pipeline consumes them.
+ * Video files and image directories are timed by their frame index at #ReplaySource::fps .
+ * A replay source is not live, so that #FramePipeline never drops its frames and the output is deterministic.
+ */
+class ReplaySource : public FrameSourceInterface
+{
+public:
+    /**
+     * @brief REPLAY_FORMAT represents the kind of a recording.
+     */
+    enum REPLAY_FORMAT
+    {
+        FORMAT_VIDEO,           //!< a video file
+        FORMAT_IMAGE_DIRECTORY, //!< a directory of PGM or PNG images
+        FORMAT_RAW_DUMP         //!< a raw frame dump
+    };
+
+    /**
+     * @brief RawFrameHeader is the header of each frame in a raw frame dump.
+     */
+    struct RawFrameHeader
+    {
+        /**
+         * @brief magic is always #ReplaySource::RAW_FRAME_MAGIC .
+         */
+        quint32 magic;
+        /**
+         * @brief width is the number of columns of the frame.
+         */
+        qint32 width;
+        /**
+         * @brief height is the number of rows of the frame.
+         */
+        qint32 height;
+        /**
+         * @brief type is the OpenCV type of the frame, `CV_8UC3` (BGR) or `CV_8UC1`.
+         */
+        qint32 type;
+        /**
+         * @brief timestamp is the capture time of the frame in us.
+         */
+        qint64 timestamp;
+    };
+    /**
+     * @brief RAW_FRAME_MAGIC marks the beginning of a frame in a raw frame dump. It is "GRF0" in little endian.
+     */
+    static const quint32 RAW_FRAME_MAGIC = 0x30465247;
+
+    /**
+     * @brief path is the path of the recording.
+     */
+    const QString &path;
+    /**
+     * @brief format is the kind of the recording.
+     */
+    const REPLAY_FORMAT &format;
+    /**
+     * @brief fps is the FPS at which video files and image directories are replayed.
+     */
+    const double &fps;
+
+    /**
+     * @param path : path of the recording
+     * @param realtime : `true` to replay at the recorded timing, or `false` to replay as fast as possible
+     * @param fps : the FPS at which an image directory is replayed. Video files use their own FPS if available.
+     */
+    explicit ReplaySource(const QString &path, const bool &realtime = true, const double &fps = CAMERA_FPS);
+    /**
+     * @brief ReplaySource replays the recording as the given kind instead of guessing it by #ReplaySource::formatOf .
+     */
+    ReplaySource(const QString &path, const REPLAY_FORMAT &format, const bool &realtime = true, const double &fps = CAMERA_FPS);
+
+    bool open() override;
+    bool isOpened() const override;
+    void release() override;
+    bool read(cv::Mat &frame) override;
+    bool atEnd() const override;
+    bool isLive() const override;
+    cv::Size frameSize() const override;
+
+    /**
+     * @brief formatOf guesses the kind of the recording at the given path.
+     */
+    static REPLAY_FORMAT formatOf(const QString &path);
+    /**
+     * @brief writeRawFrame appends a frame to a raw frame dump.
+     * @param file : an opened, writable file
+     * @param frame : a `CV_8UC3` or `CV_8UC1` frame
+     * @param timestamp : the capture time of the frame in us
+     * @return if the frame was written
+     */
+    static bool writeRawFrame(QFile &file, const cv::Mat &frame, const qint64 &timestamp);
+
+private:
+    bool _readNext(cv::Mat &frame, qint64 &timestamp);
+    void _wait(const qint64 &timestamp);
+
+    QString _path;
+    REPLAY_FORMAT _format;
+    bool _realtime;
+    double _fps;
+
+    bool _opened;
+    bool _at_end;
+    cv::Size _frame_size;
+    quint64 _index;
+
+    cv::VideoCapture _video;
+    QStringList _images;
+    QFile _raw;
+
+    cv::Mat _peeked_frame;
+    qint64 _peeked_timestamp;
+
+    QElapsedTimer _clock;
+    qint64 _first_timestamp;
+};
+
+#endif // REPLAYSOURCE_H
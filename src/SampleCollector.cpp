@@ -24,13 +24,31 @@ cv::Mat SampleCollector::resizeSample(const cv::Mat &sample)
     if (sample.empty() || (sample.rows == sample_image_size.height && sample.cols == sample_image_size.width))
         return cv::Mat(sample);
 
-    cv::Mat result(sample_image_size, CV_8UC1);
+    cv::Mat result;
+    resizeSample(sample, result);
+    return result;
+}
+
+void SampleCollector::resizeSample(const cv::Mat &sample, cv::Mat &result)
+{
+    result.create(sample_image_size, CV_8UC1);
+    if (sample.empty())
+    {
+        result.setTo(cv::Scalar(0));
+        return;
+    }
+    if (sample.rows == sample_image_size.height && sample.cols == sample_image_size.width)
+    {
+        sample.copyTo(result);
+        return;
+    }
+
     float scalex = (float)sample_image_size.width/sample.cols;
     float scaley = (float)sample_image_size.height/sample.rows;
     if (scalex == scaley)
     {
         cv::resize(sample, result, sample_image_size, 0, 0, cv::INTER_LINEAR);
-        return result;
+        return;
     }
 
     result.setTo(cv::Scalar(0));
@@ -48,11 +66,9 @@ cv::Mat SampleCollector::resizeSample(const cv::Mat &sample)
         size.width  = std::ceil(sample.cols*scaley);
         x = (sample_image_size.width-size.width)/2;
     }
-    cv::Mat tmp;
-    cv::resize(sample, tmp, size);
-    tmp.copyTo(result(cv::Rect(x,y,size.width,size.height)));
-
-    return result;
+    // resized in place, as the view has the size already
+    cv::Mat view = result(cv::Rect(x,y,size.width,size.height));
+    cv::resize(sample, view, size);
 }
 
 bool SampleCollector::setStoragePath(const QString &sample_folder, const QString &label_name)
@@ -74,7 +90,9 @@ bool SampleCollector::sample(const cv::Mat &image)
 {
     if (image.empty())
         return false;
-    QPixmap img = ImgConvertor::cvMat2QPixmap(resizeSample(image));
+    // QImage, unlike QPixmap, needs no GUI application; it refers to the data of `sample`
+    cv::Mat sample = resizeSample(image);
+    QImage img = ImgConvertor::cvMat2QImage(sample);
     QString file_name = QString::number(qrand());
     while (true)
     {
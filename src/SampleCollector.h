@@ -97,6 +97,15 @@ public:
      * @see #SampleCollector::sample
      */
     virtual cv::Mat resizeSample(const cv::Mat &sample);
+    /**
+     * @brief resizeSample resizes the given sample image with certain size into the given image.
+     *
+     * Unlike the other overload, the sample is copied even if it has the size already, and nothing is allocated if `result` has the size already.
+     *
+     * @param sample : the sample image
+     * @param result : the place where the image after resizing will be stored
+     */
+    virtual void resizeSample(const cv::Mat &sample, cv::Mat &result);
 
     /**
      * @brief setStoragePath sets the path to store the next sample images.
@@ -38,6 +38,7 @@ void SettingView::setToCurrentSettings()
     _ui_sld_vertical2->setValue(_settings->roi_end_y);
     _ui_box_detection_area->setValue(_settings->skin_detection_area);
     _ui_box_morphology->setChecked(_settings->skin_morphology);
+    _ui_box_bg_learning_rate->setValue(_settings->background_learning_rate);
 }
 
 void SettingView::setToDefaultSettings()
@@ -57,6 +58,7 @@ void SettingView::setToDefaultSettings()
     _ui_sld_vertical2->setValue(DEFAULT_ROI_END_Y);
     _ui_box_detection_area->setValue(DEFAULT_SKIN_DETECTION_AREA);
     _ui_box_morphology->setChecked(DEFAULT_SKIN_MORPHOLOGY);
+    _ui_box_bg_learning_rate->setValue(DEFAULT_BACKGROUND_LEARNING_RATE);
 }
 
 void SettingView::activatePage(const SettingView::SETTING_VIEW_PAGE &page)
@@ -106,6 +108,11 @@ void SettingView::syncSettings()
         _settings->setSkinMorphology(_ui_box_morphology->isChecked());
         _flag_change_morphology = false;
     }
+    if (_flag_change_bg_learning_rate)
+    {
+        _settings->setBackgroundLearningRate(_ui_box_bg_learning_rate->value());
+        _flag_change_bg_learning_rate = false;
+    }
 }
 
 void SettingView::_uiSldHue1ValueChanged(const int &val)
@@ -220,6 +227,12 @@ void SettingView::_uiBoxMorphologyToggled(const bool &checked)
     emit changeMorphology(checked);
 }
 
+void SettingView::_uiBoxBgLearningRateValueChanged(const double &val)
+{
+    _flag_change_bg_learning_rate = true;
+    emit changeBackgroundLearningRate(val);
+}
+
 void SettingView::_emitSkinColorRangeChangeSignal()
 {
     emit changeSkinColorLowerBound(_ui_sld_hue1->value()        < _ui_sld_hue2->value()        ? _ui_sld_hue1->value() : _ui_sld_hue2->value(),
@@ -480,7 +493,18 @@ void SettingView::_setupUi()
     QHBoxLayout * ui_background_page_button_box = new QHBoxLayout;
     ui_background_page_button_box->setContentsMargins(10, 0, 10, 0);
     ui_background_page_button_box->setSpacing(0);
+    QLabel * ui_lbl_bg_learning_rate = new QLabel(tr("Learning Rate"));
+    _ui_box_bg_learning_rate = new QDoubleSpinBox;
+    _ui_box_bg_learning_rate->setRange(0, 1);
+    _ui_box_bg_learning_rate->setDecimals(3);
+    _ui_box_bg_learning_rate->setSingleStep(0.005);
+    _ui_box_bg_learning_rate->setFocusPolicy(Qt::StrongFocus);
+    _ui_box_bg_learning_rate->setStyleSheet("QDoubleSpinBox {outline:none}");
     ui_background_page_button_box->addWidget(_ui_btn_bg_clear, 0, Qt::AlignLeft);
+    ui_background_page_button_box->addStretch();
+    ui_background_page_button_box->addWidget(ui_lbl_bg_learning_rate);
+    ui_background_page_button_box->addWidget(_ui_box_bg_learning_rate);
+    ui_background_page_button_box->addStretch();
     ui_background_page_button_box->addWidget(_ui_btn_bg_set, 0, Qt::AlignRight);
     QVBoxLayout * ui_background_page_layout = new QVBoxLayout;
     ui_background_page_layout->setContentsMargins(0, 0, 0, 0);
@@ -545,6 +569,8 @@ void SettingView::_setupUi()
     ui_lbl_detection_area->setFont(font);
     _ui_box_detection_area->setFont(font);
     _ui_box_morphology->setFont(font);
+    ui_lbl_bg_learning_rate->setFont(font);
+    _ui_box_bg_learning_rate->setFont(font);
     if (font.pixelSize() < 0)
     {
         if (font.pointSize() > 8)
@@ -583,6 +609,7 @@ void SettingView::_makeConnections()
     connect(_ui_btn_general_default,SIGNAL(released()),        this, SLOT(setToDefaultSettings()));
     connect(_ui_btn_bg_set,         SIGNAL(released()),        this, SLOT(_backgroundSettingRequest()));
     connect(_ui_btn_bg_clear,       SIGNAL(released()),        this, SLOT(_backgroundClearingRequest()));
+    connect(_ui_box_bg_learning_rate, SIGNAL(valueChanged(double)), this, SLOT(_uiBoxBgLearningRateValueChanged(double)));
     connect(_ui_btn_gesture_add,    SIGNAL(released()),        this, SLOT(_gestureListAdd()));
     connect(_ui_btn_gesture_remove, SIGNAL(released()),        this, SLOT(_gestureListRemove()));
     connect(_ui_lst_gesture,        SIGNAL(itemDoubleClicked(QListWidgetItem*)), this, SLOT(_gestureEdit(QListWidgetItem*)));
@@ -10,6 +10,7 @@
 #include <QLabel>
 #include <QSlider>
 #include <QSpinBox>
+#include <QDoubleSpinBox>
 #include <QCheckBox>
 #include <QPushButton>
 #include <QGroupBox>
@@ -127,17 +128,24 @@ signals:
      * @see #HandDetector::setMorphology
      */
     void changeMorphology(const bool &perform_morphology);
+    /**
+     * @brief changeBackgroundLearningRate is the signal of the new weight by which the background pixels of each frame are blended into the background image.
+     * @param rate : the weight, or 0 to keep the background image as set
+     *
+     * @see #HandDetector::setBackgroundLearningRate
+     */
+    void changeBackgroundLearningRate(const double &rate);
     /**
      * @brief backgroundSettingRequest is the signal of the request for setting background image for the background subtractor.
      *
-     * @see #HandDetector::_bg_subtractor
+     * @see #HandDetector::_background
      * @see #HandDetector::setBackgroundImage
      */
     void backgroundSettingRequest();
     /**
      * @brief backgroundClearingRequest is the signal of the request for clearing background image for the background subtractor.
      *
-     * @see #HandDetector::_bg_subtractor
+     * @see #HandDetector::_background
      * @see #HandDetector::clearBackgroundImage
      */
     void backgroundClearingRequest();
@@ -170,7 +178,7 @@ public slots:
      * @brief setBackgroundImage displays the given image as the background image used by the background subtractor.
      * @param img : the image shown in the setting window as the background image used by the background subtractor
      *
-     * @see #HandDetector::_bg_subtractor
+     * @see #HandDetector::_background
      * @see #HandDetector::backgroundImageSet
      */
     void setBackgroundImage(const QPixmap &img);
@@ -178,7 +186,7 @@ public slots:
      * @brief clearBackgroundImage clears the shown background image.
      *        Use this func when the brackground subtraction is turned off.
      *
-     * @see #HandDetector::_bg_subtractor
+     * @see #HandDetector::_background
      * @see #HandDetector::backgroundImageCleared
      */
     void clearBackgroundImage();
@@ -196,6 +204,7 @@ private slots:
     void _uiSldVertical2ValueChanged(const int &val);
     void _uiBoxDetectionAreaValueChanged(const int &val);
     void _uiBoxMorphologyToggled(const bool &checked);
+    void _uiBoxBgLearningRateValueChanged(const double &val);
     void _backgroundSettingRequest();
     void _backgroundClearingRequest();
     void _gestureListAdd();
@@ -242,6 +251,7 @@ private:
     QLabel      *_ui_lbl_background;
     QPushButton *_ui_btn_bg_set;
     QPushButton *_ui_btn_bg_clear;
+    QDoubleSpinBox *_ui_box_bg_learning_rate;
 
     QListWidget *_ui_lst_gesture;
     QPushButton *_ui_btn_gesture_add;
@@ -254,6 +264,7 @@ private:
     bool _flag_change_roi_y = false;
     bool _flag_change_detection_area = false;
     bool _flag_change_morphology = false;
+    bool _flag_change_bg_learning_rate = false;
 
 };
 
@@ -156,6 +156,51 @@ public:
      * @param perform_morphology : the flag to perform the morphological transformation or not
      */
     void setSkinMorphology(const bool &perform_morphology);
+    /**
+     * @brief detection_pyramid_scale is the factor by which the image is shrunk to locate the hand before detecting it at full resolution.
+     */
+    const int &detection_pyramid_scale;
+    /**
+     * @brief setDetectionPyramidScale sets the factor by which the image is shrunk to locate the hand.
+     * @param scale : the factor, or 1 to detect on the whole image at full resolution
+     */
+    void setDetectionPyramidScale(const int &scale);
+    /**
+     * @brief detection_max_hands is the maximum number of hands detected in an image.
+     */
+    const int &detection_max_hands;
+    /**
+     * @brief setDetectionMaxHands sets the maximum number of hands detected in an image.
+     * @param hands : the number of hands, at least 1
+     */
+    void setDetectionMaxHands(const int &hands);
+    /**
+     * @brief detection_tracking is the flag if the hand is searched around its last position while controlling.
+     */
+    const bool &detection_tracking;
+    /**
+     * @brief setDetectionTracking sets if the hand is searched around its last position while controlling.
+     * @param tracking : the flag to search around the last position or not
+     */
+    void setDetectionTracking(const bool &tracking);
+    /**
+     * @brief background_learning_rate is the weight by which the background pixels of each frame are blended into the background image. 0 keeps the background image as set.
+     */
+    const double &background_learning_rate;
+    /**
+     * @brief setBackgroundLearningRate sets the weight by which the background pixels of each frame are blended into the background image.
+     * @param rate : the weight, e.g. 0.01, or 0 to keep the background image as set
+     */
+    void setBackgroundLearningRate(const double &rate);
+    /**
+     * @brief standby_timeout is the time, in ms, without any hand detected after which the controlling task goes into standby. 0 disables the standby.
+     */
+    const int &standby_timeout;
+    /**
+     * @brief setStandbyTimeout sets the time without any hand detected after which the controlling task goes into standby.
+     * @param ms : the timeout in milliseconds, or 0 to disable the standby
+     */
+    void setStandbyTimeout(const int &ms);
     /**
      * @brief sampling_amount_per_time is the amount of samples collected once.
      */
@@ -287,6 +332,11 @@ private:
     int _skin_color_max_V;
     int _skin_detection_area;
     bool _skin_morpology;
+    int _detection_pyramid_scale;
+    int _detection_max_hands;
+    bool _detection_tracking;
+    double _background_learning_rate;
+    int _standby_timeout;
     int _sampling_amount_per_time;
     int _sampling_interval;
     int _gesture_selected;
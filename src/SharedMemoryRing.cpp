@@ -0,0 +1,310 @@
+#include "SharedMemoryRing.h"
+
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "the shared memory ring needs address-free atomics");
+
+namespace
+{
+
+const std::size_t ALIGNMENT = 64;
+
+std::size_t alignUp(const std::size_t &size)
+{
+    return (size + ALIGNMENT - 1)/ALIGNMENT*ALIGNMENT;
+}
+
+const std::size_t HEADER_SIZE = alignUp(sizeof(SharedMemoryRing::Header));
+const std::size_t SLOT_STRIDE = alignUp(sizeof(SharedMemoryRing::Slot));
+
+QByteArray shmName(const QString &name)
+{
+    return (name.startsWith("/") ? name : QString("/") + name).toLocal8Bit();
+}
+
+/**
+ * @brief Lease keeps a slot leased and the ring mapped as long as a frame refers to the slot.
+ */
+struct Lease
+{
+    std::shared_ptr<void> mapping;
+    SharedMemoryRing::Slot *slot;
+};
+
+/**
+ * @brief The LeaseAllocator class returns the lease of a slot when the last `cv::Mat` referring to the slot is released.
+ */
+class LeaseAllocator : public cv::MatAllocator
+{
+public:
+    cv::UMatData *allocate(int dims, const int *sizes, int type, void *data, size_t *step, int flags, cv::UMatUsageFlags usage_flags) const override
+    {
+        // a frame who is recreated gets an ordinary buffer
+        return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usage_flags);
+    }
+    bool allocate(cv::UMatData *data, int access_flags, cv::UMatUsageFlags usage_flags) const override
+    {
+        return cv::Mat::getStdAllocator()->allocate(data, access_flags, usage_flags);
+    }
+    void deallocate(cv::UMatData *data) const override
+    {
+        if (data == nullptr)
+            return;
+        auto lease = static_cast<Lease *>(data->userdata);
+        lease->slot->leases.fetch_sub(1);
+        delete lease;
+        delete data;
+    }
+};
+
+const LeaseAllocator lease_allocator;
+
+}
+
+struct SharedMemoryRing::Mapping
+{
+    SharedMemoryRing::Header *header;
+    std::size_t size;
+
+    Mapping(void *addr, const std::size_t &size) : header(static_cast<SharedMemoryRing::Header *>(addr)), size(size) {}
+    ~Mapping()
+    {
+        munmap(header, size);
+    }
+};
+
+SharedMemoryRing::SharedMemoryRing() :
+    _owner(false),
+    _seq(0),
+    _writing_slot(-1),
+    _next_slot(0)
+{}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+    detach();
+}
+
+bool SharedMemoryRing::create(const QString &name, const quint64 &slot_size, const quint32 &slot_count)
+{
+    detach();
+    if (slot_count == 0 || slot_size == 0)
+        return false;
+    const auto shm_name = shmName(name);
+    shm_unlink(shm_name.constData());
+    auto fd = shm_open(shm_name.constData(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        return false;
+
+    const auto data_offset = HEADER_SIZE + slot_count*SLOT_STRIDE;
+    const auto size = data_offset + slot_count*alignUp(slot_size);
+    void *addr = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+        addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        shm_unlink(shm_name.constData());
+        return false;
+    }
+    _mapping = std::make_shared<Mapping>(addr, size);
+    _name = name;
+    _owner = true;
+    _seq = 0;
+    _writing_slot = -1;
+    _next_slot = 0;
+
+    auto header = new (addr) Header;
+    header->slot_count = slot_count;
+    header->reserved = 0;
+    header->slot_size = alignUp(slot_size);
+    header->data_offset = data_offset;
+    header->last_seq.store(0);
+    header->closed.store(0);
+    for (quint32 i = 0; i < slot_count; ++i)
+    {
+        auto slot = new (_slot(i)) Slot;
+        slot->seq.store(0);
+        slot->leases.store(0);
+    }
+    header->version = VERSION;
+    // the consumer checks the magic number last
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = MAGIC;
+    return true;
+}
+
+bool SharedMemoryRing::attach(const QString &name)
+{
+    detach();
+    auto fd = shm_open(shmName(name).constData(), O_RDWR, 0600);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    void *addr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= HEADER_SIZE)
+        addr = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        return false;
+    auto mapping = std::make_shared<Mapping>(addr, st.st_size);
+    auto header = mapping->header;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->magic != MAGIC || header->version != VERSION || header->slot_count == 0 ||
+            header->data_offset != HEADER_SIZE + header->slot_count*SLOT_STRIDE ||
+            header->data_offset + header->slot_count*header->slot_size > mapping->size)
+        return false;
+    _mapping = mapping;
+    _name = name;
+    _owner = false;
+    // only one consumer is attached at a time; leases of a consumer who exited are dropped
+    for (quint32 i = 0; i < header->slot_count; ++i)
+        _slot(i)->leases.store(0);
+    return true;
+}
+
+void SharedMemoryRing::detach()
+{
+    if (!_mapping)
+        return;
+    if (_owner)
+    {
+        close();
+        shm_unlink(shmName(_name).constData());
+    }
+    // frames taken before keep the mapping alive through their leases
+    _mapping.reset();
+    _owner = false;
+}
+
+bool SharedMemoryRing::isAttached() const
+{
+    return _mapping != nullptr;
+}
+
+cv::Mat SharedMemoryRing::beginWrite(const cv::Size &size, const int &type)
+{
+    if (!_owner || (type != CV_8UC3 && type != CV_8UC1) || size.width <= 0 || size.height <= 0)
+        return cv::Mat();
+    const auto header = _mapping->header;
+    if (static_cast<quint64>(size.area())*CV_ELEM_SIZE(type) > header->slot_size)
+        return cv::Mat();
+
+    const auto next_seq = _seq + 1;
+    for (quint32 k = 0; k < header->slot_count; ++k)
+    {
+        const auto index = (_next_slot + k) % header->slot_count;
+        auto slot = _slot(index);
+        if (slot->leases.load() != 0)
+            continue;
+        const auto previous = slot->seq.load();
+        slot->seq.store(2*next_seq - 1);
+        // a consumer may have leased the slot in between; it will see the odd sequence and give the slot up
+        if (slot->leases.load() != 0)
+        {
+            slot->seq.store(previous);
+            continue;
+        }
+        slot->width = size.width;
+        slot->height = size.height;
+        slot->type = type;
+        _writing_slot = static_cast<int>(index);
+        return cv::Mat(size, type, _data(index));
+    }
+    return cv::Mat();
+}
+
+void SharedMemoryRing::endWrite(const qint64 &timestamp)
+{
+    if (!_owner || _writing_slot < 0)
+        return;
+    auto slot = _slot(_writing_slot);
+    slot->timestamp = timestamp;
+    ++_seq;
+    slot->seq.store(2*_seq, std::memory_order_release);
+    _mapping->header->last_seq.store(_seq, std::memory_order_release);
+    _next_slot = (_writing_slot + 1) % _mapping->header->slot_count;
+    _writing_slot = -1;
+}
+
+bool SharedMemoryRing::publish(const cv::Mat &frame, const qint64 &timestamp)
+{
+    auto slot_frame = beginWrite(frame.size(), frame.type());
+    if (slot_frame.empty())
+        return false;
+    frame.copyTo(slot_frame);
+    endWrite(timestamp);
+    return true;
+}
+
+void SharedMemoryRing::close()
+{
+    if (_owner && _mapping)
+        _mapping->header->closed.store(1, std::memory_order_release);
+}
+
+bool SharedMemoryRing::take(const quint64 &after, cv::Mat &frame, quint64 &seq, qint64 &timestamp)
+{
+    if (!_mapping || _mapping->header->last_seq.load(std::memory_order_acquire) <= after)
+        return false;
+    const auto header = _mapping->header;
+    // a few attempts, since the producer may reuse the newest slot while it is being leased
+    for (int attempt = 0; attempt < 4; ++attempt)
+    {
+        int newest = -1;
+        quint64 newest_seq = 2*after;
+        for (quint32 i = 0; i < header->slot_count; ++i)
+        {
+            const auto s = _slot(i)->seq.load(std::memory_order_acquire);
+            if (s % 2 == 0 && s > newest_seq)
+            {
+                newest = static_cast<int>(i);
+                newest_seq = s;
+            }
+        }
+        if (newest < 0)
+            return false;
+
+        auto slot = _slot(newest);
+        slot->leases.fetch_add(1);
+        if (slot->seq.load() != newest_seq)
+        {
+            slot->leases.fetch_sub(1);
+            continue;
+        }
+
+        cv::Mat m(slot->height, slot->width, slot->type, _data(newest));
+        auto u = new cv::UMatData(&lease_allocator);
+        u->data = u->origdata = m.data;
+        u->size = m.total()*m.elemSize();
+        u->userdata = new Lease{_mapping, slot};
+        u->refcount = 1;
+        m.u = u;
+        m.allocator = const_cast<LeaseAllocator *>(&lease_allocator);
+        frame = m;
+        seq = newest_seq/2;
+        timestamp = slot->timestamp;
+        return true;
+    }
+    return false;
+}
+
+bool SharedMemoryRing::isClosed() const
+{
+    return _mapping && _mapping->header->closed.load(std::memory_order_acquire) != 0;
+}
+
+SharedMemoryRing::Slot *SharedMemoryRing::_slot(const quint32 &index) const
+{
+    return reinterpret_cast<Slot *>(reinterpret_cast<uchar *>(_mapping->header) + HEADER_SIZE + index*SLOT_STRIDE);
+}
+
+uchar *SharedMemoryRing::_data(const quint32 &index) const
+{
+    return reinterpret_cast<uchar *>(_mapping->header) + _mapping->header->data_offset + index*_mapping->header->slot_size;
+}
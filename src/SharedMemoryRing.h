@@ -0,0 +1,170 @@
+#ifndef SHAREDMEMORYRING_H
+#define SHAREDMEMORYRING_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The SharedMemoryRing.h file contains the ring buffer of frames in POSIX shared memory through which another local process publishes frames.
+ */
+#include <atomic>
+#include <memory>
+#include <QString>
+#include <opencv2/opencv.hpp>
+
+#ifndef SHM_RING_SLOTS
+/**
+ * @brief SHM_RING_SLOTS is the default number of frame slots in a shared memory ring.
+ *
+ * A slot is held as long as the frame read from it is in the pipeline, so the ring should be larger than the number of frames in flight.
+ */
+#define SHM_RING_SLOTS 16
+#endif
+
+/**
+ * @brief The SharedMemoryRing class is a ring of frame slots in POSIX shared memory with one producer process and one consumer process.
+ *
+ * The producer, e.g. the service who owns the camera, creates the ring by #SharedMemoryRing::create and writes each frame
+ * either directly into a slot via #SharedMemoryRing::beginWrite and #SharedMemoryRing::endWrite, or by copying via #SharedMemoryRing::publish .
+ * The consumer attaches to the ring by #SharedMemoryRing::attach and takes the newest frame by #SharedMemoryRing::take
+ * without copying it: the returned `cv::Mat` refers to the slot, which is leased to the consumer until the last `cv::Mat` referring to it is released.
+ * The producer never writes into a leased slot, and drops the frame if all slots are leased.
+ *
+ * Each slot is guarded by a sequence lock, whose value is odd while the producer writes the slot and twice the frame sequence number once the frame is complete.
+ *
+ * **ATTENTION**:
+ *  The ring lives in memory shared by processes, such that only lock-free atomic operations are used.
+ *  Frames are `CV_8UC3` (BGR) or `CV_8UC1` and their rows are continuous.
+ */
+class SharedMemoryRing
+{
+public:
+    /**
+     * @brief MAGIC marks a ring created by #SharedMemoryRing::create . It is "GRS0" in little endian.
+     */
+    static const quint32 MAGIC = 0x30535247;
+    /**
+     * @brief VERSION is the version of the memory layout of the ring.
+     */
+    static const quint32 VERSION = 1;
+
+    /**
+     * @brief Slot is the header of a frame slot in shared memory.
+     */
+    struct Slot
+    {
+        /**
+         * @brief seq is 0 if the slot is empty, odd while the producer writes the slot, or twice the sequence number of the frame in it.
+         */
+        std::atomic<quint64> seq;
+        /**
+         * @brief leases is the number of `cv::Mat` buffers of the consumer referring to the slot.
+         */
+        std::atomic<quint32> leases;
+        qint32 width;
+        qint32 height;
+        qint32 type;
+        qint64 timestamp;
+    };
+    /**
+     * @brief Header is the header of the ring in shared memory. It is followed by the #Slot headers and then the frame data of each slot.
+     */
+    struct Header
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 slot_count;
+        quint32 reserved;
+        quint64 slot_size;
+        quint64 data_offset;
+        /**
+         * @brief last_seq is the sequence number of the newest frame published, starting at 1.
+         */
+        std::atomic<quint64> last_seq;
+        /**
+         * @brief closed is set by the producer after the last frame.
+         */
+        std::atomic<quint32> closed;
+    };
+
+    SharedMemoryRing();
+    ~SharedMemoryRing();
+    SharedMemoryRing(const SharedMemoryRing &) = delete;
+    SharedMemoryRing &operator=(const SharedMemoryRing &) = delete;
+
+    /**
+     * @brief create creates the ring as the producer. A ring of the same name created before is replaced.
+     * @param name : name of the shared memory object, e.g. `/gesture-camera`. A leading `/` is added if missing.
+     * @param slot_size : the maximum size, in bytes, of a frame
+     * @param slot_count : the number of slots
+     * @return if the ring is created
+     */
+    bool create(const QString &name, const quint64 &slot_size, const quint32 &slot_count = SHM_RING_SLOTS);
+    /**
+     * @brief attach attaches to the ring created by the producer as the consumer. The leases of a previous consumer are dropped.
+     * @param name : name of the shared memory object
+     * @return if the ring exists and has a known layout
+     */
+    bool attach(const QString &name);
+    /**
+     * @brief detach detaches from the ring. The producer also removes the shared memory object.
+     *
+     * Frames taken before stay valid until they are released.
+     */
+    void detach();
+    /**
+     * @brief isAttached returns if the ring was created or attached.
+     */
+    bool isAttached() const;
+
+    /**
+     * @brief beginWrite gives the producer the next free slot as a frame to be filled.
+     * @param size : size of the frame
+     * @param type : `CV_8UC3` or `CV_8UC1`
+     * @return a frame referring to the slot, or an empty frame if the frame does not fit into a slot or all slots are leased
+     */
+    cv::Mat beginWrite(const cv::Size &size, const int &type);
+    /**
+     * @brief endWrite publishes the frame given by the last call of #SharedMemoryRing::beginWrite .
+     * @param timestamp : the capture time of the frame in us
+     */
+    void endWrite(const qint64 &timestamp);
+    /**
+     * @brief publish copies a frame into the next free slot and publishes it.
+     * @return if the frame was published
+     */
+    bool publish(const cv::Mat &frame, const qint64 &timestamp);
+    /**
+     * @brief close tells the consumer that no more frame will be published.
+     */
+    void close();
+
+    /**
+     * @brief take takes the newest frame published after the given one, without copying it.
+     * @param after : sequence number of the frame taken last time, or 0
+     * @param frame : the place where the frame will be stored. The slot is leased until the frame and all its copies are released.
+     * @param seq : the place where the sequence number of the frame will be stored
+     * @param timestamp : the place where the capture time of the frame will be stored
+     * @return if a newer frame was taken
+     */
+    bool take(const quint64 &after, cv::Mat &frame, quint64 &seq, qint64 &timestamp);
+    /**
+     * @brief isClosed returns if the producer closed the ring.
+     */
+    bool isClosed() const;
+
+protected:
+    struct Mapping;
+
+    Slot *_slot(const quint32 &index) const;
+    uchar *_data(const quint32 &index) const;
+
+private:
+    std::shared_ptr<Mapping> _mapping;
+    QString _name;
+    bool _owner;
+
+    quint64 _seq;
+    int _writing_slot;
+    quint32 _next_slot;
+};
+
+#endif // SHAREDMEMORYRING_H
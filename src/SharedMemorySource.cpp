@@ -0,0 +1,90 @@
+#include "SharedMemorySource.h"
+
+#include <QThread>
+#include <QElapsedTimer>
+
+SharedMemorySource::SharedMemorySource(const QString &name) :
+    _name(name),
+    _last_seq(0),
+    _at_end(false)
+{}
+
+bool SharedMemorySource::open()
+{
+    if (_ring.isAttached())
+        return true;
+    if (!_ring.attach(_name))
+        return false;
+    _last_seq = 0;
+    _at_end = false;
+    // wait for the first frame to know the frame size before the pipeline starts
+    if (!_take(_peeked_frame))
+    {
+        release();
+        return false;
+    }
+    _frame_size = _peeked_frame.size();
+    return true;
+}
+
+bool SharedMemorySource::isOpened() const
+{
+    return _ring.isAttached();
+}
+
+void SharedMemorySource::release()
+{
+    _peeked_frame.release();
+    _ring.detach();
+}
+
+bool SharedMemorySource::read(cv::Mat &frame)
+{
+    if (!_ring.isAttached())
+        return false;
+    if (!_peeked_frame.empty())
+    {
+        frame = _peeked_frame;
+        _peeked_frame = cv::Mat();
+        return true;
+    }
+    return _take(frame);
+}
+
+bool SharedMemorySource::atEnd() const
+{
+    return _at_end;
+}
+
+bool SharedMemorySource::isLive() const
+{
+    return true;
+}
+
+cv::Size SharedMemorySource::frameSize() const
+{
+    return _frame_size;
+}
+
+bool SharedMemorySource::_take(cv::Mat &frame)
+{
+    QElapsedTimer timer;
+    timer.start();
+    quint64 seq;
+    qint64 timestamp;
+    while (!_ring.take(_last_seq, frame, seq, timestamp))
+    {
+        if (_ring.isClosed())
+        {
+            _at_end = true;
+            return false;
+        }
+        if (timer.elapsed() > SHM_READ_TIMEOUT)
+            return false;
+        QThread::usleep(SHM_POLL_INTERVAL);
+    }
+    _last_seq = seq;
+    if (frame.channels() == 1)
+        cv::cvtColor(frame, frame, cv::COLOR_GRAY2BGR);
+    return true;
+}
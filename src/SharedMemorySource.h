@@ -0,0 +1,63 @@
+#ifndef SHAREDMEMORYSOURCE_H
+#define SHAREDMEMORYSOURCE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The SharedMemorySource.h file contains the frame source who reads frames published by another local process through shared memory.
+ */
+#include <QString>
+#include <opencv2/opencv.hpp>
+
+#include "FrameSourceInterface.h"
+#include "SharedMemoryRing.h"
+
+#ifndef SHM_READ_TIMEOUT
+/**
+ * @brief SHM_READ_TIMEOUT is the time, in ms, after which reading from a shared memory ring without any new frame fails.
+ */
+#define SHM_READ_TIMEOUT 2000
+#endif
+#ifndef SHM_POLL_INTERVAL
+/**
+ * @brief SHM_POLL_INTERVAL is the time, in us, between two checks of a shared memory ring for a new frame.
+ */
+#define SHM_POLL_INTERVAL 200
+#endif
+
+/**
+ * @brief The SharedMemorySource class reads the frames published into a #SharedMemoryRing by another process, e.g. the service who owns the camera.
+ *
+ * Frames are not copied: each frame read refers to a slot of the ring, which the producer does not overwrite until the frame is released.
+ * Only the newest frame is read; frames published in between are skipped like a camera does.
+ * Gray frames are converted into BGR, which costs a copy.
+ *
+ * The source reaches its end when the producer closes the ring, and fails when no new frame arrives within #SHM_READ_TIMEOUT ms.
+ */
+class SharedMemorySource : public FrameSourceInterface
+{
+public:
+    /**
+     * @param name : name of the shared memory object created by the producer
+     */
+    explicit SharedMemorySource(const QString &name);
+
+    bool open() override;
+    bool isOpened() const override;
+    void release() override;
+    bool read(cv::Mat &frame) override;
+    bool atEnd() const override;
+    bool isLive() const override;
+    cv::Size frameSize() const override;
+
+private:
+    bool _take(cv::Mat &frame);
+
+    QString _name;
+    SharedMemoryRing _ring;
+    quint64 _last_seq;
+    bool _at_end;
+    cv::Size _frame_size;
+    cv::Mat _peeked_frame;
+};
+
+#endif // SHAREDMEMORYSOURCE_H
@@ -0,0 +1,192 @@
+#include "SkinColorTable.h"
+#include "ParallelInvoker.h"
+
+namespace
+{
+
+// pixels classified by each parallel stripe at least, such that small images are not split
+const int STRIPE_PIXELS = 1 << 14;
+
+template <typename Function>
+void parallelRows(const cv::Mat &img, const Function &function)
+{
+    parallelFor(cv::Range(0, img.rows), function, std::max(1, img.rows*img.cols/STRIPE_PIXELS));
+}
+
+}
+
+SkinColorTable::Table::Table() :
+    cells(32*32*32, CELL_OUTSIDE),
+    bits((1 << 24)/64, 0)
+{}
+
+SkinColorTable::SkinColorTable() :
+    _table(new Table),
+    _built(false),
+    _building(false),
+    _builder(this)
+{}
+
+SkinColorTable::~SkinColorTable()
+{
+    _builder.wait();
+}
+
+void SkinColorTable::setBounds(const cv::Scalar &lower, const cv::Scalar &upper)
+{
+    if (_built && lower == _table->lower && upper == _table->upper)
+        return;
+    _table->lower = lower;
+    _table->upper = upper;
+    _table->build();
+    _built = true;
+}
+
+bool SkinColorTable::requestBounds(const cv::Scalar &lower, const cv::Scalar &upper)
+{
+    if (!_built)
+    {
+        setBounds(lower, upper);
+        return true;
+    }
+    // the table just built replaces the one in use, which is then free to be rebuilt
+    if (_building && _builder.isFinished())
+    {
+        _builder.wait();
+        _building = false;
+        std::swap(_table, _next);
+    }
+    if (lower == _table->lower && upper == _table->upper)
+        return true;
+    // the bounds requested meanwhile are only checked again once the table being built is complete
+    if (!_building)
+    {
+        if (!_next)
+            _next.reset(new Table);
+        _next->lower = lower;
+        _next->upper = upper;
+        _building = true;
+        _builder.start(QThread::LowPriority);
+    }
+    return false;
+}
+
+void SkinColorTable::Builder::run()
+{
+    _table->_next->build();
+}
+
+void SkinColorTable::classify(const cv::Mat &bgr, cv::Mat &mask, const cv::Mat &background) const
+{
+    CV_Assert(bgr.type() == CV_8UC3 && (background.empty() || (background.type() == CV_8UC3 && background.size() == bgr.size())));
+    mask.create(bgr.size(), CV_8UC1);
+    const Table &table = *_table;
+    const uchar black = table.classify(0, 0, 0);
+    parallelRows(bgr, [&](const cv::Range &rows) {
+        uchar foreground[64];
+        for (int y = rows.start; y < rows.end; ++y)
+        {
+            const uchar *src = bgr.ptr<uchar>(y);
+            uchar *dst = mask.ptr<uchar>(y);
+            if (background.empty())
+            {
+                for (int x = 0; x < bgr.cols; ++x, src += 3)
+                    dst[x] = table.classify(src[0], src[1], src[2]);
+                continue;
+            }
+            const uchar *ref = background.ptr<uchar>(y);
+            // the background is tested on a chunk of pixels at once, which stays in cache for the lookup
+            for (int x = 0; x < bgr.cols; x += 64)
+            {
+                const int n = std::min(64, bgr.cols - x);
+                BackgroundModel::foreground(src + 3*x, ref + 3*x, foreground, n);
+                for (int i = 0; i < n; ++i)
+                {
+                    const uchar *p = src + 3*(x+i);
+                    dst[x+i] = foreground[i] ? table.classify(p[0], p[1], p[2]) : black;
+                }
+            }
+        }
+    });
+}
+
+void SkinColorTable::classify(const cv::Mat &bgr, BinaryMask &mask, const cv::Mat &background) const
+{
+    CV_Assert(bgr.type() == CV_8UC3 && (background.empty() || (background.type() == CV_8UC3 && background.size() == bgr.size())));
+    mask.create(bgr.size());
+    if (background.empty())
+        parallelRows(bgr, [&](const cv::Range &rows) { _classifyRows<false>(bgr, mask, background, rows); });
+    else
+        parallelRows(bgr, [&](const cv::Range &rows) { _classifyRows<true>(bgr, mask, background, rows); });
+}
+
+template <bool BACKGROUND>
+void SkinColorTable::_classifyRows(const cv::Mat &bgr, BinaryMask &mask, const cv::Mat &background, const cv::Range &rows) const
+{
+    const Table &table = *_table;
+    const quint64 black = table.classify(0, 0, 0) & 1;
+    uchar foreground[64];
+    for (int y = rows.start; y < rows.end; ++y)
+    {
+        const uchar *src = bgr.ptr<uchar>(y);
+        const uchar *ref = BACKGROUND ? background.ptr<uchar>(y) : nullptr;
+        quint64 *dst = mask.row(y);
+        for (int i = 0, x = 0; i < mask.wordsPerRow(); ++i, x += 64)
+        {
+            const int n = std::min(64, bgr.cols - x);
+            const uchar *p = src + 3*x;
+            quint64 word = 0;
+            if (BACKGROUND)
+                BackgroundModel::foreground(p, ref + 3*x, foreground, n);
+            for (int b = 0; b < n; ++b, p += 3)
+            {
+                const quint64 skin = table.classify(p[0], p[1], p[2]) & 1;
+                // foreground is 0 or 255, so that it selects between the color and black without a branch
+                const quint64 bit = BACKGROUND ? (skin & foreground[b]) | (black & ~foreground[b]) : skin;
+                word |= (bit & 1) << b;
+            }
+            dst[i] = word;
+        }
+    }
+}
+
+void SkinColorTable::Table::build()
+{
+    // filter all the 2^24 colors in 256 images, one for each value of the first channel
+    cv::Mat colors(256, 256, CV_8UC3), hsv, passed;
+    std::vector<int> counts(cells.size(), 0);
+    for (int b = 0; b < 256; ++b)
+    {
+        for (int g = 0; g < 256; ++g)
+        {
+            auto row = colors.ptr<uchar>(g);
+            for (int r = 0; r < 256; ++r, row += 3)
+            {
+                row[0] = static_cast<uchar>(b);
+                row[1] = static_cast<uchar>(g);
+                row[2] = static_cast<uchar>(r);
+            }
+        }
+        // the same conversion as the skin color filter of HandDetector
+        cv::cvtColor(colors, hsv, cv::COLOR_RGB2HSV);
+        cv::inRange(hsv, lower, upper, passed);
+        for (int g = 0; g < 256; ++g)
+        {
+            const auto row = passed.ptr<uchar>(g);
+            quint64 *word = &bits[((b << 16) | (g << 8)) >> 6];
+            for (int w = 0; w < 4; ++w)
+            {
+                quint64 passed_bits = 0;
+                for (int i = 0; i < 64; ++i)
+                    if (row[w*64 + i])
+                        passed_bits |= quint64(1) << i;
+                word[w] = passed_bits;
+            }
+            for (int r = 0; r < 256; ++r)
+                if (row[r])
+                    ++counts[_cellIndex(b, g, r)];
+        }
+    }
+    for (std::size_t i = 0; i < cells.size(); ++i)
+        cells[i] = counts[i] == 0 ? CELL_OUTSIDE : (counts[i] == 8*8*8 ? CELL_INSIDE : CELL_BORDER);
+}
@@ -0,0 +1,146 @@
+#ifndef SKINCOLORTABLE_H
+#define SKINCOLORTABLE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The SkinColorTable.h file contains the lookup table who classifies pixels by the skin color filter without converting them into HSV.
+ */
+#include <memory>
+#include <vector>
+#include <QtGlobal>
+#include <QThread>
+#include <opencv2/opencv.hpp>
+
+#include "BinaryMask.h"
+#include "BackgroundModel.h"
+
+/**
+ * @brief The SkinColorTable class answers, for each 24-bit color, if it passes the skin color filter of #HandDetector .
+ *
+ * The filter is `cv::cvtColor(img, hsv, cv::COLOR_RGB2HSV)` followed by `cv::inRange(hsv, lower, upper, mask)`.
+ * The images given to the hand detector are in BGR, so that they are converted as if they were RGB; the table keeps this behavior
+ * such that its masks are identical to those of the filter.
+ *
+ * The table has two levels:
+ *
+ *  - a coarse table of 32x32x32 cells, one byte each, telling if all, none or only some of the 512 colors in the cell pass the filter, and
+ *  - a bit for each of the 2^24 colors, only looked up for the cells of the third kind, which lie on the border of the filter.
+ *
+ * Most pixels are classified by the 32 KB coarse table. Both levels are built when the bounds change, which costs some tens of ms.
+ * #SkinColorTable::setBounds builds them at once, whereas #SkinColorTable::requestBounds builds them into a second table on a thread of its own,
+ * which replaces the table in use once it is complete, so that the bounds changed by a slider do not stall the detection.
+ *
+ * Classifying an image also subtracts the background, if given, in the same pass, and is split into stripes of rows run in parallel.
+ */
+class SkinColorTable
+{
+public:
+    SkinColorTable();
+    ~SkinColorTable();
+    SkinColorTable(const SkinColorTable &) = delete;
+    SkinColorTable &operator=(const SkinColorTable &) = delete;
+
+    /**
+     * @brief setBounds sets the bounds of the skin color filter in HSV color space and rebuilds the table at once if they changed.
+     * @param lower : lower bound of h, s and v
+     * @param upper : upper bound of h, s and v
+     */
+    void setBounds(const cv::Scalar &lower, const cv::Scalar &upper);
+    /**
+     * @brief requestBounds sets the bounds of the skin color filter in HSV color space, and rebuilds the table in the background if they changed.
+     *
+     * The table in use keeps classifying with the former bounds until the one of the new bounds is complete, and is replaced by it
+     * in a later call. Bounds requested while a table is being built are not built but the last of them, after that table is complete.
+     * The table is built at once if there is none yet.
+     *
+     * It must be called by the thread who classifies.
+     *
+     * @param lower : lower bound of h, s and v
+     * @param upper : upper bound of h, s and v
+     * @return if the table in use has the given bounds
+     */
+    bool requestBounds(const cv::Scalar &lower, const cv::Scalar &upper);
+    /**
+     * @brief classify computes the mask of the skin color filter in one pass.
+     * @param bgr : a `CV_8UC3` image
+     * @param mask : the place where the `CV_8UC1` mask, 255 for the pixels passing the filter, will be stored
+     * @param background : an optional `CV_8UC3` background image of the same size. Pixels not differing from it, as tested by #BackgroundModel::foreground ,
+     *                     are classified as black ones, as if they were erased before filtering.
+     */
+    void classify(const cv::Mat &bgr, cv::Mat &mask, const cv::Mat &background = cv::Mat()) const;
+    /**
+     * @brief classify computes the mask of the skin color filter as a bit-packed mask.
+     * @see #SkinColorTable::classify(const cv::Mat &, cv::Mat &, const cv::Mat &) const
+     */
+    void classify(const cv::Mat &bgr, BinaryMask &mask, const cv::Mat &background = cv::Mat()) const;
+    /**
+     * @brief contains returns if the color passes the skin color filter.
+     */
+    inline bool contains(const uchar &b, const uchar &g, const uchar &r) const;
+
+private:
+    enum CELL
+    {
+        CELL_OUTSIDE = 0,
+        CELL_BORDER = 1,
+        CELL_INSIDE = 255
+    };
+    // both levels of the table of some bounds
+    struct Table
+    {
+        cv::Scalar lower;
+        cv::Scalar upper;
+        std::vector<uchar> cells;
+        std::vector<quint64> bits;
+        Table();
+        void build();
+        inline bool contains(const uchar &b, const uchar &g, const uchar &r) const;
+        inline uchar classify(const uchar &b, const uchar &g, const uchar &r) const;
+    };
+    // the thread building the second table
+    class Builder : public QThread
+    {
+    public:
+        explicit Builder(SkinColorTable *table) : _table(table) {}
+    protected:
+        void run() override;
+    private:
+        SkinColorTable *_table;
+    };
+
+    template <bool BACKGROUND>
+    void _classifyRows(const cv::Mat &bgr, BinaryMask &mask, const cv::Mat &background, const cv::Range &rows) const;
+    inline static int _cellIndex(const uchar &b, const uchar &g, const uchar &r);
+
+    std::unique_ptr<Table> _table; // the table in use
+    std::unique_ptr<Table> _next; // the table built by the builder, who alone touches it while it runs
+    bool _built; // if the table in use has been built once
+    bool _building; // if the builder has been started and not joined yet
+    Builder _builder;
+};
+
+int SkinColorTable::_cellIndex(const uchar &b, const uchar &g, const uchar &r)
+{
+    return ((b >> 3) << 10) | ((g >> 3) << 5) | (r >> 3);
+}
+
+bool SkinColorTable::Table::contains(const uchar &b, const uchar &g, const uchar &r) const
+{
+    const quint32 color = (static_cast<quint32>(b) << 16) | (static_cast<quint32>(g) << 8) | r;
+    return (bits[color >> 6] >> (color & 63)) & 1;
+}
+
+uchar SkinColorTable::Table::classify(const uchar &b, const uchar &g, const uchar &r) const
+{
+    const auto cell = cells[_cellIndex(b, g, r)];
+    if (cell != CELL_BORDER)
+        return cell;
+    return contains(b, g, r) ? 255 : 0;
+}
+
+bool SkinColorTable::contains(const uchar &b, const uchar &g, const uchar &r) const
+{
+    return _table->contains(b, g, r);
+}
+
+#endif // SKINCOLORTABLE_H
@@ -0,0 +1,150 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The SpscQueue.h file contains a bounded lock-free queue for passing data between two threads.
+ */
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief The SpscQueue template is a bounded lock-free queue with a single producer and a single consumer.
+ *
+ * **ATTENTION**:
+ *  Only one thread may call #SpscQueue::push and only one (other) thread may call #SpscQueue::pop.
+ *
+ * The capacity is rounded up to a power of two. Neither #SpscQueue::push nor #SpscQueue::pop blocks;
+ * they return `false` when the queue is full or empty respectively, and the caller decides whether to wait or to drop.
+ *
+ * @tparam T : type of the elements. It must be default constructible and movable.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(const size_t &capacity);
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+     * @brief push appends an element at the tail of the queue. Producer only.
+     * @param item : the element which will be moved into the queue
+     * @retval true : if the element was appended
+     * @retval false : if the queue is full. `item` is left untouched.
+     */
+    bool push(T &&item);
+    /**
+     * @brief pop takes the element at the head of the queue. Consumer only.
+     * @param item : the place where the element will be moved to
+     * @retval true : if an element was taken
+     * @retval false : if the queue is empty
+     */
+    bool pop(T &item);
+    /**
+     * @brief clear drops all elements in the queue. Consumer only.
+     * @return the number of elements dropped
+     */
+    size_t clear();
+
+    /**
+     * @brief size returns the number of elements in the queue. The value may be outdated as soon as it returns.
+     */
+    size_t size() const;
+    /**
+     * @brief empty returns if the queue is empty. The value may be outdated as soon as it returns.
+     */
+    bool empty() const;
+    /**
+     * @brief capacity returns the maximum number of elements the queue can hold.
+     */
+    size_t capacity() const;
+
+private:
+    static size_t _roundUp(const size_t &n);
+
+    const size_t _capacity;
+    const size_t _mask;
+    std::vector<T> _slots;
+    // head and tail are written by different threads; keep them on separate cache lines
+    char _pad0[64];
+    std::atomic<size_t> _head;
+    char _pad1[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> _tail;
+    char _pad2[64 - sizeof(std::atomic<size_t>)];
+};
+
+template <typename T>
+SpscQueue<T>::SpscQueue(const size_t &capacity) :
+    _capacity(_roundUp(capacity)),
+    _mask(_capacity - 1),
+    _slots(_capacity),
+    _head(0),
+    _tail(0)
+{}
+
+template <typename T>
+bool SpscQueue<T>::push(T &&item)
+{
+    const size_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail - _head.load(std::memory_order_acquire) == _capacity)
+        return false;
+    _slots[tail & _mask] = std::move(item);
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool SpscQueue<T>::pop(T &item)
+{
+    const size_t head = _head.load(std::memory_order_relaxed);
+    if (head == _tail.load(std::memory_order_acquire))
+        return false;
+    item = std::move(_slots[head & _mask]);
+    // release whatever the slot still references (e.g. the buffer of a cv::Mat)
+    _slots[head & _mask] = T();
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+size_t SpscQueue<T>::clear()
+{
+    size_t dropped = 0;
+    T item;
+    while (pop(item))
+        ++dropped;
+    return dropped;
+}
+
+template <typename T>
+size_t SpscQueue<T>::size() const
+{
+    // read head first so that the tail read afterwards is never behind it
+    const size_t head = _head.load(std::memory_order_acquire);
+    return _tail.load(std::memory_order_acquire) - head;
+}
+
+template <typename T>
+bool SpscQueue<T>::empty() const
+{
+    return size() == 0;
+}
+
+template <typename T>
+size_t SpscQueue<T>::capacity() const
+{
+    return _capacity;
+}
+
+template <typename T>
+size_t SpscQueue<T>::_roundUp(const size_t &n)
+{
+    size_t c = 1;
+    while (c < n)
+        c <<= 1;
+    return c;
+}
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,69 @@
+#include "StageProfiler.h"
+
+#include <QFile>
+#include <QTextStream>
+
+StageProfiler::StageProfiler()
+{}
+
+QString StageProfiler::stageName(const STAGE &stage)
+{
+    switch (stage)
+    {
+    case STAGE_CAMERA_READ:
+        return "camera_read";
+    case STAGE_CROP:
+        return "crop";
+    case STAGE_PREPROCESSING:
+        return "preprocessing";
+    case STAGE_FINGER_EXTRACTION:
+        return "finger_extraction";
+    case STAGE_RESIZE_SAMPLE:
+        return "resize_sample";
+    case STAGE_FORWARD:
+        return "forward";
+    case STAGE_INPUT:
+        return "input";
+    case STAGE_PIXMAP:
+        return "pixmap";
+    case STAGE_PRESENCE_CHECK:
+        return "presence_check";
+    default:
+        return QString();
+    }
+}
+
+void StageProfiler::record(const STAGE &stage, const qint64 &us)
+{
+    _histograms[stage].record(us);
+}
+
+const LatencyHistogram &StageProfiler::histogram(const STAGE &stage) const
+{
+    return _histograms[stage];
+}
+
+void StageProfiler::reset()
+{
+    for (auto &h : _histograms)
+        h.reset();
+}
+
+bool StageProfiler::writeCsv(const QString &file) const
+{
+    QFile f(file);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+    QTextStream out(&f);
+    out << "stage,count,mean_us,p50_us,p95_us,p99_us,max_us\n";
+    for (int i = 0; i < STAGE_COUNT; ++i)
+    {
+        const auto s = _histograms[i].summary();
+        out << stageName(static_cast<STAGE>(i)) << ','
+            << s.count << ','
+            << QString::number(s.mean, 'f', 1) << ','
+            << s.p50 << ',' << s.p95 << ',' << s.p99 << ',' << s.max << '\n';
+    }
+    out.flush();
+    return f.error() == QFile::NoError;
+}
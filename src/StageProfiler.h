@@ -0,0 +1,76 @@
+#ifndef STAGEPROFILER_H
+#define STAGEPROFILER_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The StageProfiler.h file contains the class who collects the latency of each stage a frame goes through.
+ */
+#include <QString>
+
+#include "LatencyHistogram.h"
+
+/**
+ * @brief The StageProfiler class keeps a #LatencyHistogram for each stage a frame goes through, from the camera to the command.
+ *
+ * Stages are recorded from the thread where they run, i.e. the stage threads of #FramePipeline and the owner thread.
+ *
+ * @see #FramePipeline::setStageProfiler
+ */
+class StageProfiler
+{
+public:
+    /**
+     * @brief STAGE represents a stage a frame goes through.
+     */
+    enum STAGE
+    {
+        STAGE_CAMERA_READ,        //!< reading a frame from the frame source
+        STAGE_CROP,               //!< fitting the region of interesting of the frame
+        STAGE_PREPROCESSING,      //!< skin color filtering and background subtraction in the hand detector
+        STAGE_FINGER_EXTRACTION,  //!< contour and convexity analysis in the hand detector
+        STAGE_RESIZE_SAMPLE,      //!< resizing the extracted hand image for the network
+        STAGE_FORWARD,            //!< the forward pass of the network, including the conversion of its input
+        STAGE_INPUT,              //!< making the keyboard or mouse command
+        STAGE_PIXMAP,             //!< converting images into pixmaps for the windows
+        STAGE_PRESENCE_CHECK,     //!< the low resolution presence check during standby
+        STAGE_COUNT               //!< number of stages
+    };
+
+    StageProfiler();
+    StageProfiler(const StageProfiler &) = delete;
+    StageProfiler &operator=(const StageProfiler &) = delete;
+
+    /**
+     * @brief stageName returns the name of the given stage.
+     */
+    static QString stageName(const STAGE &stage);
+
+    /**
+     * @brief record records the latency of a stage.
+     * @param stage : the stage
+     * @param us : the latency in us
+     */
+    void record(const STAGE &stage, const qint64 &us);
+    /**
+     * @brief histogram returns the histogram of the given stage.
+     */
+    const LatencyHistogram &histogram(const STAGE &stage) const;
+    /**
+     * @brief reset drops the samples of all stages.
+     */
+    void reset();
+    /**
+     * @brief writeCsv writes the summary of each stage into a CSV file.
+     *
+     * The columns are `stage,count,mean_us,p50_us,p95_us,p99_us,max_us`.
+     *
+     * @param file : path of the file
+     * @return if the file is written
+     */
+    bool writeCsv(const QString &file) const;
+
+private:
+    LatencyHistogram _histograms[STAGE_COUNT];
+};
+
+#endif // STAGEPROFILER_H
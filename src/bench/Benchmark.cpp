@@ -0,0 +1,144 @@
+#include "Benchmark.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <opencv2/opencv.hpp>
+
+namespace
+{
+
+std::atomic<quint64> allocation_count(0);
+
+void *countedAlloc(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0)
+        size = 1;
+    return std::malloc(size);
+}
+
+/**
+ * @brief The CountingMatAllocator class counts the buffers allocated for `cv::Mat` and delegates the allocation to the standard allocator.
+ */
+class CountingMatAllocator : public cv::MatAllocator
+{
+public:
+    explicit CountingMatAllocator(cv::MatAllocator *allocator) : _allocator(allocator) {}
+
+    cv::UMatData *allocate(int dims, const int *sizes, int type, void *data, size_t *step, int flags, cv::UMatUsageFlags usage_flags) const override
+    {
+        if (data == nullptr)
+            allocation_count.fetch_add(1, std::memory_order_relaxed);
+        return _allocator->allocate(dims, sizes, type, data, step, flags, usage_flags);
+    }
+    bool allocate(cv::UMatData *data, int access_flags, cv::UMatUsageFlags usage_flags) const override
+    {
+        return _allocator->allocate(data, access_flags, usage_flags);
+    }
+    void deallocate(cv::UMatData *data) const override
+    {
+        _allocator->deallocate(data);
+    }
+
+private:
+    cv::MatAllocator *_allocator;
+};
+
+}
+
+void *operator new(std::size_t size)
+{
+    auto p = countedAlloc(size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](std::size_t size)
+{
+    auto p = countedAlloc(size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    std::free(p);
+}
+
+Benchmark::Benchmark(const qint64 &min_time_ms, const QString &filter) :
+    _min_time_ns(min_time_ms*1000000),
+    _filter(filter),
+    _out(stdout)
+{
+    static CountingMatAllocator mat_allocator(cv::Mat::getStdAllocator());
+    cv::Mat::setDefaultAllocator(&mat_allocator);
+
+    _out << QString("%1%2%3%4\n").arg("operation", -56).arg("iterations", 12).arg("ns/op", 14).arg("allocs/op", 12);
+    _out.flush();
+}
+
+Benchmark::~Benchmark()
+{
+    cv::Mat::setDefaultAllocator(nullptr);
+}
+
+void Benchmark::skip(const QString &name, const QString &reason)
+{
+    if (!_selected(name))
+        return;
+    _out << QString("%1%2\n").arg(name, -56).arg("skipped: " + reason);
+    _out.flush();
+}
+
+const std::vector<Benchmark::Result> &Benchmark::results() const
+{
+    return _results;
+}
+
+quint64 Benchmark::allocations()
+{
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+bool Benchmark::_selected(const QString &name) const
+{
+    return _filter.isEmpty() || name.contains(_filter, Qt::CaseInsensitive);
+}
+
+void Benchmark::_report(const Result &result)
+{
+    _results.push_back(result);
+    _out << QString("%1%2%3%4\n").arg(result.name, -56)
+            .arg(result.iterations, 12)
+            .arg(QString::number(result.ns_per_op, 'f', 1), 14)
+            .arg(QString::number(result.allocs_per_op, 'f', 2), 12);
+    _out.flush();
+}
@@ -0,0 +1,150 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The Benchmark.h file contains the harness who times the hot functions in isolation.
+ */
+#include <utility>
+#include <vector>
+#include <QString>
+#include <QTextStream>
+#include <QElapsedTimer>
+
+/**
+ * @brief The Benchmark class runs an operation repeatedly and reports the time and the number of allocations per operation.
+ *
+ * The number of iterations is doubled until a run takes at least the minimum time, after one warm-up call.
+ * Allocations are counted through the global `operator new` and the default `cv::MatAllocator`,
+ * i.e. every C++ object and every `cv::Mat` buffer. Buffers allocated by `malloc` in C libraries are not counted.
+ *
+ * **ATTENTION**:
+ *  Only one #Benchmark should exist at a time, since it replaces the default `cv::MatAllocator`.
+ */
+class Benchmark
+{
+public:
+    /**
+     * @brief Result is the measurement of one operation.
+     */
+    struct Result
+    {
+        QString name;
+        quint64 iterations;
+        double ns_per_op;
+        double allocs_per_op;
+    };
+
+    /**
+     * @param min_time_ms : the minimum time, in ms, of the measured run of each operation
+     * @param filter : only operations whose name contains the filter are run
+     */
+    explicit Benchmark(const qint64 &min_time_ms, const QString &filter = QString());
+    ~Benchmark();
+    Benchmark(const Benchmark &) = delete;
+    Benchmark &operator=(const Benchmark &) = delete;
+
+    /**
+     * @brief run measures the given operation unless it is filtered out.
+     * @param name : name of the operation
+     * @param op : the operation, a callable without argument
+     */
+    template<typename Op>
+    void run(const QString &name, Op &&op);
+    /**
+     * @brief measure measures the given operation a fixed number of times after warming it up.
+     *
+     * Unlike #Benchmark::run , it is never filtered out.
+     *
+     * @param name : name of the operation
+     * @param op : the operation, a callable without argument
+     * @param warmups : the number of calls before the measured ones, during which buffers may grow
+     * @param iterations : the number of calls measured
+     * @return the measurement
+     */
+    template<typename Op>
+    Result measure(const QString &name, Op &&op, const int &warmups, const quint64 &iterations);
+    /**
+     * @brief checkNoAllocation measures the given operation as #Benchmark::measure does, and tells if the measured calls allocated nothing.
+     */
+    template<typename Op>
+    bool checkNoAllocation(const QString &name, Op &&op, const int &warmups, const quint64 &iterations);
+    /**
+     * @brief skip reports that an operation cannot be measured.
+     */
+    void skip(const QString &name, const QString &reason);
+    /**
+     * @brief results returns the measurements so far.
+     */
+    const std::vector<Result> &results() const;
+    /**
+     * @brief allocations returns the number of allocations counted since the program started.
+     */
+    static quint64 allocations();
+
+private:
+    bool _selected(const QString &name) const;
+    void _report(const Result &result);
+
+    qint64 _min_time_ns;
+    QString _filter;
+    std::vector<Result> _results;
+    QTextStream _out;
+};
+
+template<typename Op>
+void Benchmark::run(const QString &name, Op &&op)
+{
+    if (!_selected(name))
+        return;
+    // warm up the caches and any lazily allocated buffers
+    op();
+
+    QElapsedTimer timer;
+    quint64 iterations = 1;
+    while (true)
+    {
+        const auto allocations_before = allocations();
+        timer.start();
+        for (quint64 i = 0; i < iterations; ++i)
+            op();
+        const auto elapsed = timer.nsecsElapsed();
+        const auto allocations_made = allocations() - allocations_before;
+        if (elapsed >= _min_time_ns || iterations >= (1ull << 40))
+        {
+            _report(Result{name, iterations,
+                           static_cast<double>(elapsed)/iterations,
+                           static_cast<double>(allocations_made)/iterations});
+            return;
+        }
+        iterations *= 2;
+    }
+}
+
+template<typename Op>
+Benchmark::Result Benchmark::measure(const QString &name, Op &&op, const int &warmups, const quint64 &iterations)
+{
+    for (int i = 0; i < warmups; ++i)
+        op();
+
+    QElapsedTimer timer;
+    const auto allocations_before = allocations();
+    timer.start();
+    for (quint64 i = 0; i < iterations; ++i)
+        op();
+    const auto elapsed = timer.nsecsElapsed();
+    const auto allocations_made = allocations() - allocations_before;
+    const Result result{name, iterations,
+                        static_cast<double>(elapsed)/iterations,
+                        static_cast<double>(allocations_made)/iterations};
+    _report(result);
+    return result;
+}
+
+template<typename Op>
+bool Benchmark::checkNoAllocation(const QString &name, Op &&op, const int &warmups, const quint64 &iterations)
+{
+    return measure(name, std::forward<Op>(op), warmups, iterations).allocs_per_op == 0;
+}
+
+#endif // BENCHMARK_H
@@ -0,0 +1,416 @@
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The main.cpp file of the micro-benchmark of the hot functions.
+ *
+ * All inputs are derived from the images in the `samples` folder, or a recording given by `--frames`,
+ * such that the numbers are comparable across commits. Run `bench --help` for all options.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDebug>
+
+#include "Benchmark.h"
+#include "HandDetector.h"
+#include "SkinColorTable.h"
+#include "BinaryMask.h"
+#include "BackgroundModel.h"
+#include "SampleCollector.h"
+#include "GestureAnalyst.h"
+#include "CommandInputter.h"
+#include "ImgConvertor.h"
+#include "ReplaySource.h"
+
+#ifndef BENCH_SAMPLES_DIR
+/**
+ * @brief BENCH_SAMPLES_DIR is the folder of the sample images used as inputs by default.
+ */
+#define BENCH_SAMPLES_DIR "samples"
+#endif
+#ifndef BENCH_CHECK_SAMPLE
+/**
+ * @brief BENCH_CHECK_SAMPLE is the sample image, a white hand on black, from which the frame of `--check-allocations` is made.
+ */
+#define BENCH_CHECK_SAMPLE "Palm.jpg"
+#endif
+#ifndef BENCH_CHECK_WARMUPS
+/**
+ * @brief BENCH_CHECK_WARMUPS is the number of detections before those checked by `--check-allocations`, during which the buffers grow.
+ */
+#define BENCH_CHECK_WARMUPS 10
+#endif
+#ifndef BENCH_CHECK_ITERATIONS
+/**
+ * @brief BENCH_CHECK_ITERATIONS is the number of detections checked by `--check-allocations`.
+ */
+#define BENCH_CHECK_ITERATIONS 100
+#endif
+#ifndef BENCH_CHECK_IN_FLIGHT
+/**
+ * @brief BENCH_CHECK_IN_FLIGHT is the number of #HandObservation kept in flight by `--check-allocations`, as in the queues of #FramePipeline .
+ */
+#define BENCH_CHECK_IN_FLIGHT 6
+#endif
+#ifndef BENCH_MAX_FRAMES
+/**
+ * @brief BENCH_MAX_FRAMES is the maximum number of frames loaded from a recording given by `--frames`.
+ */
+#define BENCH_MAX_FRAMES 300
+#endif
+
+namespace
+{
+
+/**
+ * @brief The BenchGestureAnalyst class can build the shipped network without a trained model.
+ *
+ * The time of a forward pass does not depend on the weights, so that the network is benchmarked even if no model file is given.
+ */
+class BenchGestureAnalyst : public GestureAnalyst
+{
+public:
+    bool loadUntrained()
+    {
+        if (!_buildNetwork())
+            return false;
+        caffe::Blob<float> * input_layer = _net->input_blobs()[0];
+        _input_geometry = cv::Size(input_layer->width(), input_layer->height());
+        return true;
+    }
+};
+
+/**
+ * @brief The BenchCommandInputter class exposes the action counting of #CommandInputter without making any command.
+ */
+class BenchCommandInputter : public CommandInputter
+{
+public:
+    void countAction(const MOUSE_KEYBOARD_ACTION &action)
+    {
+        _countAction(action);
+    }
+    void freshActionCount()
+    {
+        _freshActionCount();
+    }
+};
+
+std::vector<cv::Mat> loadSamples(const QString &dir, const int &flags)
+{
+    std::vector<cv::Mat> samples;
+    QDir d(dir);
+    for (const auto &f : d.entryList(QStringList() << "*.jpg" << "*.png" << "*.pgm", QDir::Files, QDir::Name))
+    {
+        auto img = cv::imread(d.filePath(f).toStdString(), flags);
+        if (!img.empty())
+            samples.push_back(img);
+    }
+    return samples;
+}
+
+/**
+ * @brief checkAllocations checks that passing the hand found on a fixed frame on to other threads allocates nothing in steady state.
+ *
+ * It does what the worker of #FramePipeline does after a detection: #HandDetector::observe into a record, whose crop is
+ * taken from a #HandObservationPool , while older records are released as by the threads done with them.
+ * The detection itself and the resizing of the crop are only reported, since the OpenCV functions they call,
+ * e.g. `cv::findContours` and `cv::resize` , allocate their temporary buffers on every call.
+ *
+ * @return if nothing was allocated and the hand was detected every time
+ */
+bool checkAllocations(Benchmark &bench, const QString &samples_dir)
+{
+    const auto sample = cv::imread(QDir(samples_dir).filePath(BENCH_CHECK_SAMPLE).toStdString(), cv::IMREAD_GRAYSCALE);
+    if (sample.empty())
+    {
+        qCritical().noquote() << "No sample image" << BENCH_CHECK_SAMPLE << "found in" << samples_dir;
+        return false;
+    }
+    // green passes the default skin color filter, and black does not
+    cv::Mat hand;
+    cv::resize(sample, hand, cv::Size(256, 256));
+    cv::Mat frame = cv::Mat::zeros(360, 480, CV_8UC3);
+    frame(cv::Rect(112, 64, hand.cols, hand.rows)).setTo(cv::Scalar(0, 255, 0), hand > 127);
+
+    bool passed = true;
+    for (const bool tracking : {false, true})
+    {
+        const QString suffix = QString(" tracking=%1").arg(tracking ? "on" : "off");
+        HandDetector detector;
+        detector.setTracking(tracking);
+        int detected = 0;
+        bench.measure("HandDetector::detectShared steady state" + suffix, [&]{
+            detected += detector.detectShared(frame);
+        }, BENCH_CHECK_WARMUPS, BENCH_CHECK_ITERATIONS);
+        if (detected != BENCH_CHECK_WARMUPS + BENCH_CHECK_ITERATIONS)
+        {
+            qCritical().noquote() << "The hand was detected" << detected << "times out of" << BENCH_CHECK_WARMUPS + BENCH_CHECK_ITERATIONS;
+            passed = false;
+        }
+
+        HandObservationPool pool(SampleCollector::sample_image_size);
+        std::vector<HandObservation> in_flight(BENCH_CHECK_IN_FLIGHT);
+        std::size_t i = 0;
+        passed = bench.checkNoAllocation("HandDetector::observe with a pooled crop" + suffix, [&]{
+            // the oldest record is dropped first, which gives its crop back to the pool
+            auto &observation = in_flight[i++ % in_flight.size()];
+            observation = HandObservation();
+            detector.observe(observation);
+            observation.crop = pool.acquireCrop();
+        }, BENCH_CHECK_WARMUPS, BENCH_CHECK_ITERATIONS) && passed;
+
+        SampleCollector collector;
+        const auto extracted = detector.extractedImage();
+        const auto crop = pool.acquireCrop();
+        bench.measure("SampleCollector::resizeSample into a pooled crop" + suffix, [&]{
+            collector.resizeSample(extracted, *crop);
+        }, BENCH_CHECK_WARMUPS, BENCH_CHECK_ITERATIONS);
+    }
+    return passed;
+}
+
+std::vector<cv::Mat> loadFrames(const QString &path)
+{
+    std::vector<cv::Mat> frames;
+    ReplaySource source(path, false);
+    if (!source.open())
+        return frames;
+    cv::Mat frame;
+    while (frames.size() < BENCH_MAX_FRAMES && source.read(frame))
+    {
+        frames.push_back(frame);
+        frame = cv::Mat();
+    }
+    source.release();
+    return frames;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("bench");
+    QCoreApplication::setApplicationVersion(APPLICATION_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks the hot functions in isolation and reports ns/op and allocations/op.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption samples_option("samples",
+                                      "Folder of the sample images used as inputs.", "dir", BENCH_SAMPLES_DIR);
+    QCommandLineOption frames_option("frames",
+                                     "Recording whose frames are used as ROI frames for the hand detector, instead of the sample images.", "path");
+    QCommandLineOption model_option(QStringList() << "m" << "model",
+                                    "Trained model file. The network is benchmarked without trained weights by default.", "file");
+    QCommandLineOption min_time_option("min-time",
+                                       "Minimum time of the measured run of each operation.", "ms", "500");
+    QCommandLineOption filter_option("filter",
+                                     "Only run the operations whose name contains the text.", "text");
+    QCommandLineOption check_option("check-allocations",
+                                    "Only check that passing the hand detected on a fixed frame on to other threads allocates nothing once warmed up, and exit with 1 if it does.");
+    parser.addOption(samples_option);
+    parser.addOption(frames_option);
+    parser.addOption(model_option);
+    parser.addOption(min_time_option);
+    parser.addOption(filter_option);
+    parser.addOption(check_option);
+    parser.process(a);
+
+    const auto gray_samples = loadSamples(parser.value(samples_option), cv::IMREAD_GRAYSCALE);
+    if (gray_samples.empty())
+    {
+        qCritical().noquote() << "No sample image found in" << parser.value(samples_option);
+        return 1;
+    }
+    auto roi_frames = parser.isSet(frames_option) ? loadFrames(parser.value(frames_option))
+                                                  : loadSamples(parser.value(samples_option), cv::IMREAD_COLOR);
+    if (roi_frames.empty())
+    {
+        qCritical().noquote() << "No frame found in" << parser.value(frames_option);
+        return 1;
+    }
+
+    Benchmark bench(parser.value(min_time_option).toLongLong(), parser.value(filter_option));
+    if (parser.isSet(check_option))
+        return checkAllocations(bench, parser.value(samples_option)) ? 0 : 1;
+
+    // hand detection
+    {
+        HandDetector detector;
+        std::size_t i = 0;
+        for (const int scale : {1, 2, 4})
+        {
+            detector.setPyramidScale(scale);
+            bench.run(QString("HandDetector::detect pyramid=%1 (%2 frames)").arg(scale).arg(roi_frames.size()), [&]{
+                detector.detect(roi_frames[i++ % roi_frames.size()]);
+            });
+        }
+        bench.run(QString("HandDetector::detectShared (%1 frames)").arg(roi_frames.size()), [&]{
+            detector.detectShared(roi_frames[i++ % roi_frames.size()]);
+        });
+        // consecutive frames, such that the hand is searched around its last position
+        detector.setPyramidScale(DEFAULT_DETECTION_PYRAMID_SCALE);
+        detector.setTracking(true);
+        bench.run(QString("HandDetector::detect tracking=on (%1 frames)").arg(roi_frames.size()), [&]{
+            detector.detect(roi_frames[i++ % roi_frames.size()]);
+        });
+        detector.setTracking(false);
+        detector.setMaxHands(2);
+        bench.run("HandDetector::detect max_hands=2", [&]{
+            detector.detect(roi_frames[i++ % roi_frames.size()]);
+        });
+        detector.setMaxHands(DEFAULT_DETECTION_MAX_HANDS);
+        detector.setMorphology(false);
+        bench.run("HandDetector::preprocess morphology=off", [&]{
+            detector.preprocess(roi_frames[i++ % roi_frames.size()]);
+        });
+        detector.setMorphology(true);
+        bench.run("HandDetector::preprocess morphology=on", [&]{
+            detector.preprocess(roi_frames[i++ % roi_frames.size()]);
+        });
+
+        // the skin color filter alone, by the lookup table and by the HSV conversion it replaces
+        const cv::Scalar lower_bound(DEFAULT_SKIN_COLOR_MIN_H, DEFAULT_SKIN_COLOR_MIN_S, DEFAULT_SKIN_COLOR_MIN_V);
+        const cv::Scalar upper_bound(DEFAULT_SKIN_COLOR_MAX_H, DEFAULT_SKIN_COLOR_MAX_S, DEFAULT_SKIN_COLOR_MAX_V);
+        SkinColorTable table;
+        table.setBounds(lower_bound, upper_bound);
+        cv::Mat hsv, mask;
+        bench.run("SkinColorTable::classify", [&]{
+            table.classify(roi_frames[i++ % roi_frames.size()], mask);
+        });
+        bench.run("cv::cvtColor RGB2HSV + cv::inRange", [&]{
+            cv::cvtColor(roi_frames[i++ % roi_frames.size()], hsv, cv::COLOR_RGB2HSV);
+            cv::inRange(hsv, lower_bound, upper_bound, mask);
+        });
+
+        // the background subtraction, tested by the skin color filter in the same pass and by the Gaussian mixture it replaces
+        std::vector<cv::Mat> same_size;
+        for (const auto &f : roi_frames)
+            if (f.size() == roi_frames[0].size())
+                same_size.push_back(f);
+        BackgroundModel background;
+        background.setReference(same_size[0]);
+        bench.run("SkinColorTable::classify with background", [&]{
+            table.classify(same_size[i++ % same_size.size()], mask, background.reference());
+        });
+        auto mog2 = cv::createBackgroundSubtractorMOG2(1, 16, false);
+        cv::Mat foreground;
+        mog2->apply(same_size[0], foreground, 1);
+        bench.run("cv::BackgroundSubtractorMOG2::apply + SkinColorTable::classify", [&]{
+            const auto &f = same_size[i++ % same_size.size()];
+            mog2->apply(f, foreground, 0);
+            cv::Mat erased;
+            f.copyTo(erased, foreground);
+            table.classify(erased, mask);
+        });
+
+        // smoothing and morphology of the skin mask, bit-packed and on 8-bit images
+        const auto kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(9, 9));
+        std::vector<cv::Mat> masks;
+        for (const auto &f : roi_frames)
+        {
+            masks.push_back(cv::Mat());
+            table.classify(f, masks.back());
+        }
+        BinaryMask packed, buffer;
+        bench.run("BinaryMask blur, threshold, open and close", [&]{
+            buffer.pack(masks[i++ % masks.size()]);
+            packed.blurThreshold(buffer, cv::Size(7, 7), 0.8, 10);
+            buffer.erode(packed, kernel);
+            packed.dilate(buffer, kernel);
+            buffer.dilate(packed, kernel);
+            packed.erode(buffer, kernel);
+            packed.unpack(mask);
+        });
+        bench.run("cv::GaussianBlur, cv::threshold and cv::morphologyEx", [&]{
+            cv::GaussianBlur(masks[i++ % masks.size()], mask, cv::Size(7, 7), 0.8);
+            cv::threshold(mask, mask, 10, 255, cv::THRESH_BINARY);
+            cv::morphologyEx(mask, mask, cv::MORPH_OPEN, kernel);
+            cv::morphologyEx(mask, mask, cv::MORPH_CLOSE, kernel);
+        });
+
+        const cv::Scalar wider_upper(upper_bound[0], upper_bound[1], 255);
+        bool wider = false;
+        bench.run("SkinColorTable::setBounds", [&]{
+            wider = !wider;
+            table.setBounds(wider ? cv::Scalar(0, 0, 0) : lower_bound,
+                            wider ? wider_upper : upper_bound);
+        });
+    }
+
+    // sample resizing
+    {
+        SampleCollector collector;
+        const cv::Size sizes[] = {
+            SampleCollector::sample_image_size,
+            cv::Size(128, 128), cv::Size(160, 120), cv::Size(120, 160), cv::Size(200, 80), cv::Size(80, 200)
+        };
+        for (const auto &size : sizes)
+        {
+            cv::Mat input;
+            cv::resize(gray_samples[0], input, size);
+            bench.run(QString("SampleCollector::resizeSample %1x%2").arg(size.width).arg(size.height), [&]{
+                collector.resizeSample(input);
+            });
+        }
+    }
+
+    // inference
+    {
+        BenchGestureAnalyst analyst;
+        bool loaded = parser.isSet(model_option) ? analyst.load(parser.value(model_option)) > 0
+                                                 : analyst.loadUntrained();
+        if (loaded)
+        {
+            SampleCollector collector;
+            std::vector<cv::Mat> inputs;
+            for (const auto &s : gray_samples)
+                inputs.push_back(collector.resizeSample(s));
+            std::size_t i = 0;
+            bench.run(QString("GestureAnalyst::analyze %1x%2").arg(SAMPLE_SIZE_WIDTH).arg(SAMPLE_SIZE_HEIGHT), [&]{
+                analyst.analyze(inputs[i++ % inputs.size()], 5);
+            });
+        }
+        else
+            bench.skip("GestureAnalyst::analyze", "failed to load the network");
+    }
+
+    // image conversion for the windows
+    {
+        cv::Mat gray, bgr, bgra;
+        cv::resize(gray_samples[0], gray, cv::Size(640, 480));
+        cv::cvtColor(gray, bgr, cv::COLOR_GRAY2BGR);
+        cv::cvtColor(gray, bgra, cv::COLOR_GRAY2BGRA);
+        bench.run("ImgConvertor::cvMat2QImage CV_8UC1 640x480", [&]{
+            ImgConvertor::cvMat2QImage(gray);
+        });
+        bench.run("ImgConvertor::cvMat2QImage CV_8UC3 640x480", [&]{
+            ImgConvertor::cvMat2QImage(bgr);
+        });
+        bench.run("ImgConvertor::cvMat2QImage CV_8UC4 640x480", [&]{
+            ImgConvertor::cvMat2QImage(bgra);
+        });
+    }
+
+    // action counting
+    {
+        BenchCommandInputter inputter;
+        // keep one counting period of actions in flight, as when controlling at the camera FPS
+        const std::size_t in_flight = (ACTION_COUNT_PERIOD)*CAMERA_FPS/1000 + 1;
+        const CommandInputter::MOUSE_KEYBOARD_ACTION actions[] = {
+            CommandInputter::MOUSE_MOVE, CommandInputter::MOUSE_LEFT_CLICK,
+            CommandInputter::MOUSE_MOVE, CommandInputter::MOUSE_DRAG
+        };
+        std::size_t i = 0;
+        for (std::size_t k = 0; k < in_flight; ++k)
+            inputter.countAction(actions[i++ % 4]);
+        bench.run("CommandInputter action counting", [&]{
+            inputter.countAction(actions[i++ % 4]);
+            inputter.freshActionCount();
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "ReplayEngine.h"
+
+ReplayEngine::ReplayEngine(HandDetector *hand_detector, SampleCollector *sample_collector, GestureAnalystInterface *gesture_analyst, CommandInputterInterface *command_inputter, QObject *parent) :
+    GestureEngine(hand_detector, sample_collector, gesture_analyst, command_inputter, parent),
+    _dry_run(false),
+    _frames_total(0),
+    _frames_processed(0),
+    _finished(false)
+{
+    connect(_pipeline, &FramePipeline::sourceFinished, this, &ReplayEngine::_sourceFinished, Qt::QueuedConnection);
+}
+
+void ReplayEngine::setDryRun(const bool &dry_run)
+{
+    _dry_run = dry_run;
+}
+
+bool ReplayEngine::setOutput(const QString &file)
+{
+    _output.setDevice(nullptr);
+    _output_file.close();
+    if (file == "-")
+    {
+        if (!_output_file.open(stdout, QIODevice::WriteOnly))
+            return false;
+    }
+    else
+    {
+        _output_file.setFileName(file);
+        if (!_output_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+    }
+    _output.setDevice(&_output_file);
+    return true;
+}
+
+bool ReplayEngine::openCamera()
+{
+    _frames_total = 0;
+    _frames_processed = 0;
+    _finished = false;
+    _read_time = _geometry_time = _detection_time = _inference_time = StageTime();
+    _clock.start();
+    return GestureEngine::openCamera();
+}
+
+void ReplayEngine::_processCapturedFrame(FramePipeline::Frame &frame)
+{
+    GestureEngine::_processCapturedFrame(frame);
+
+    ++_frames_processed;
+    _read_time.add(frame.read_us);
+    _geometry_time.add(frame.geometry_us);
+    if (frame.examined)
+        _detection_time.add(frame.detection_us);
+    if (frame.analyzed)
+        _inference_time.add(frame.inference_us);
+
+    if (_output.device() != nullptr)
+    {
+        _output << frame.id << ' ' << (frame.detected ? 1 : 0) << ' '
+                << frame.observation.tracked_point.x << ' ' << frame.observation.tracked_point.y << ' ';
+        if (frame.analyzed)
+            _output << frame.predictions[0].label_id << ' '
+                    << QString::number(frame.predictions[0].prob, 'f', 6);
+        else
+            _output << -1 << ' ' << QString::number(0.0, 'f', 6);
+        _output << '\n';
+    }
+    _finishIfDone();
+}
+
+void ReplayEngine::_recognize(const std::vector<GestureAnalystInterface::Prediction> &predictions, const cv::Point &tracked_point)
+{
+    if (!_dry_run)
+        GestureEngine::_recognize(predictions, tracked_point);
+}
+
+void ReplayEngine::_sourceFinished(const quint64 &frames)
+{
+    _frames_total = frames;
+    // an empty recording has nothing in flight
+    if (frames == 0)
+        _frames_total = _frames_processed;
+    _finishIfDone();
+}
+
+void ReplayEngine::_finishIfDone()
+{
+    // frames of a live source may be dropped on the way
+    if (_finished || _frames_total == 0 || _frames_processed + _pipeline->droppedFrames() < _frames_total)
+        return;
+    _finished = true;
+    _output.flush();
+    _printSummary();
+    emit replayFinished();
+}
+
+void ReplayEngine::_printSummary()
+{
+    const double seconds = _clock.nsecsElapsed()/1e9;
+    QTextStream err(stderr);
+    err << "frames: " << _frames_processed
+        << "  time: " << QString::number(seconds, 'f', 3) << " s"
+        << "  throughput: " << QString::number(seconds > 0 ? _frames_processed/seconds : 0.0, 'f', 1) << " frames/s\n";
+    err << QString("%1%2%3%4\n").arg("stage", -12).arg("frames", 10).arg("mean us", 12).arg("max us", 12);
+    const auto row = [&err](const QString &name, const StageTime &t) {
+        err << QString("%1%2%3%4\n").arg(name, -12)
+               .arg(t.count, 10)
+               .arg(t.count > 0 ? QString::number(static_cast<double>(t.sum)/t.count, 'f', 1) : QString("-"), 12)
+               .arg(t.max, 12);
+    };
+    row("read", _read_time);
+    row("geometry", _geometry_time);
+    row("detection", _detection_time);
+    row("inference", _inference_time);
+    err.flush();
+}
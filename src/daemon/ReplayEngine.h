@@ -0,0 +1,98 @@
+#ifndef REPLAYENGINE_H
+#define REPLAYENGINE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The ReplayEngine.h file contains the engine who drives the pipeline with a recording and reports the results and the throughput.
+ */
+#include <QFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+
+#include "GestureEngine.h"
+#include "ReplaySource.h"
+
+/**
+ * @brief The ReplayEngine class is a #GestureEngine who reports the result of every frame and a throughput summary when the frame source reaches its end.
+ *
+ * Each processed frame gives a line
+ *
+ *     <frame id> <detected> <tracked x> <tracked y> <label index> <probability>
+ *
+ * where the label index is -1 if the frame was not analyzed. Since a #ReplaySource is never dropped,
+ * replaying the same recording with the same settings and model gives the same lines.
+ *
+ * After the last frame of a recording, or after the producer of a shared memory ring closed it, the number of frames, frames/s and the mean and maximum time, in us, of each stage are printed to `stderr`,
+ * and #ReplayEngine::replayFinished is emitted.
+ */
+class ReplayEngine : public GestureEngine
+{
+    Q_OBJECT
+public:
+    explicit ReplayEngine(HandDetector *hand_detector,
+                          SampleCollector *sample_collector,
+                          GestureAnalystInterface *gesture_analyst,
+                          CommandInputterInterface *command_inputter,
+                          QObject *parent = 0);
+
+    /**
+     * @brief setDryRun sets if recognized gestures are only reported but not passed to #CommandInputterInterface::input .
+     */
+    void setDryRun(const bool &dry_run);
+    /**
+     * @brief setOutput sets the file into which the result of every frame is written.
+     * @param file : path of the file, or `-` for `stdout`
+     * @return if the file is opened
+     */
+    bool setOutput(const QString &file);
+
+    bool openCamera() override;
+
+signals:
+    /**
+     * @brief replayFinished is emitted after the last frame of the recording was processed.
+     */
+    void replayFinished();
+
+protected:
+    void _processCapturedFrame(FramePipeline::Frame &frame) override;
+    void _recognize(const std::vector<GestureAnalystInterface::Prediction> &predictions, const cv::Point &tracked_point) override;
+
+private slots:
+    void _sourceFinished(const quint64 &frames);
+
+private:
+    struct StageTime
+    {
+        qint64 sum;
+        qint64 max;
+        quint64 count;
+        StageTime() : sum(0), max(0), count(0) {}
+        void add(const qint64 &us)
+        {
+            sum += us;
+            if (us > max)
+                max = us;
+            ++count;
+        }
+    };
+
+    void _finishIfDone();
+    void _printSummary();
+
+    bool _dry_run;
+    QFile _output_file;
+    QTextStream _output;
+
+    quint64 _frames_total;
+    quint64 _frames_processed;
+    bool _finished;
+    QElapsedTimer _clock;
+
+    StageTime _read_time;
+    StageTime _geometry_time;
+    StageTime _detection_time;
+    StageTime _inference_time;
+};
+
+#endif // REPLAYENGINE_H
@@ -0,0 +1,324 @@
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The main.cpp file of the headless daemon who makes commands by gestures without any window.
+ *
+ * The hand detector and the region of interesting are configured from the same setting file used by the GUI application.
+ * The model and keymap files used last time in the GUI application are used unless others are given in the command line.
+ *
+ * With `--source`, frames are read from another backend, e.g. the shared memory published by another process. See #FrameSourceFactory .
+ * With `--replay`, frames are read from a recording instead of the camera, the result of every frame can be written via `--output`,
+ * and a throughput summary is printed when the recording ends. See #ReplayEngine .
+ * With `--stream` given more than once, each stream is processed by its own hand detector and pipeline while the gestures of all streams
+ * are recognized by one network, which analyzes the hand images of the streams in batches. See #InferenceService .
+ */
+#include <csignal>
+#include <vector>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QTextStream>
+#include <QTimer>
+
+#include "GestureEngine.h"
+#include "ReplayEngine.h"
+#include "ReplaySource.h"
+#include "FrameSourceFactory.h"
+#include "CommandInputter.h"
+#include "GestureAnalyst.h"
+#include "InferenceService.h"
+
+namespace
+{
+
+// only a flag may be set in a signal handler; the application quits from its event loop
+volatile std::sig_atomic_t quit_requested = 0;
+
+void quitOnSignal(int)
+{
+    quit_requested = 1;
+}
+
+/**
+ * @brief quitOnSignals makes the application quit on SIGINT or SIGTERM, by polling the flag set by the signal handler.
+ */
+void quitOnSignals(QCoreApplication &app)
+{
+    auto timer = new QTimer(&app);
+    QObject::connect(timer, &QTimer::timeout, [&app]() {
+        if (quit_requested)
+            app.quit();
+    });
+    timer->start(100);
+    std::signal(SIGINT, quitOnSignal);
+    std::signal(SIGTERM, quitOnSignal);
+}
+
+/**
+ * @brief streamFile returns the file of the stream with the given index, `<file>.<index>`, or `file` itself if it is `-`.
+ */
+QString streamFile(const QString &file, const int &index)
+{
+    return file == "-" ? file : file + "." + QString::number(index);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("gesture-daemon");
+    QCoreApplication::setApplicationVersion(APPLICATION_VERSION);
+
+    auto settings = Settings::getInstance();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Makes keyboard and mouse commands by gestures without any window.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption camera_option(QStringList() << "c" << "camera",
+                                     "Index of the camera.", "index", "0");
+    QCommandLineOption fps_option("fps",
+                                  "FPS requested from the camera.", "fps", QString::number(CAMERA_FPS));
+    QCommandLineOption model_option(QStringList() << "m" << "model",
+                                    "Model file. The one used last time by default.", "file", settings->cnn_model_file);
+    QCommandLineOption keymap_option(QStringList() << "k" << "keymap",
+                                     "Keymap file. The one used last time by default.", "file", settings->keymap_file);
+    QCommandLineOption verbose_option(QStringList() << "v" << "verbose",
+                                      "Print every command made.");
+    QCommandLineOption source_option(QStringList() << "s" << "source",
+                                     "Read frames from the source instead of the camera: " + FrameSourceFactory::usage() + ".", "source");
+    QCommandLineOption replay_option("replay",
+                                     "Read frames from a video file, a directory of PGM/PNG images or a .rawframes dump instead of the camera.", "path");
+    QCommandLineOption fast_option("fast",
+                                   "Replay as fast as possible instead of at the recorded timing.");
+    QCommandLineOption replay_fps_option("replay-fps",
+                                         "FPS at which an image directory is replayed.", "fps", QString::number(CAMERA_FPS));
+    QCommandLineOption dry_run_option("dry-run",
+                                      "Recognize gestures without making any command.");
+    QCommandLineOption output_option(QStringList() << "o" << "output",
+                                     "Write the result of every replayed frame into the file, or - for stdout.", "file");
+    QCommandLineOption latency_option("latency-csv",
+                                      "Write the latency of each stage into the CSV file on exit.", "file");
+    QCommandLineOption standby_option("standby-timeout",
+                                      "Go into standby after no hand was detected for the time, in ms, or never if 0. The setting file decides by default.", "ms");
+    QCommandLineOption learning_rate_option("background-learning-rate",
+                                            "Blend the pixels without any hand into the background image by the weight, or keep the background if 0. The setting file decides by default.", "rate");
+    QCommandLineOption stream_option("stream",
+                                     "Process the source as one of several streams sharing one network. Give it once per stream. "
+                                     "The output and latency files of stream i are <file>.i .", "source");
+    parser.addOption(camera_option);
+    parser.addOption(fps_option);
+    parser.addOption(model_option);
+    parser.addOption(keymap_option);
+    parser.addOption(verbose_option);
+    parser.addOption(source_option);
+    parser.addOption(replay_option);
+    parser.addOption(fast_option);
+    parser.addOption(replay_fps_option);
+    parser.addOption(dry_run_option);
+    parser.addOption(output_option);
+    parser.addOption(latency_option);
+    parser.addOption(standby_option);
+    parser.addOption(learning_rate_option);
+    parser.addOption(stream_option);
+    parser.process(a);
+
+    if (parser.isSet(stream_option))
+    {
+        const auto descriptions = parser.values(stream_option);
+        auto g = new GestureAnalyst;
+        InferenceService service(g);
+
+        std::vector<HandDetector *> detectors;
+        std::vector<SampleCollector *> collectors;
+        std::vector<CommandInputter *> inputters;
+        std::vector<ReplayEngine *> engines;
+        const auto cleanup = [&]() {
+            for (auto e : engines)
+                delete e;
+            service.stop();
+            for (auto h : detectors)
+                delete h;
+            for (auto s : collectors)
+                delete s;
+            for (auto c : inputters)
+                delete c;
+            delete g;
+        };
+
+        for (int i = 0; i < descriptions.size(); ++i)
+        {
+            auto source = FrameSourceFactory::create(descriptions.at(i),
+                                                     parser.value(fps_option).toUInt(),
+                                                     !parser.isSet(fast_option),
+                                                     parser.value(replay_fps_option).toDouble());
+            if (source == nullptr)
+            {
+                qCritical().noquote() << "Invalid frame source" << descriptions.at(i);
+                cleanup();
+                return 1;
+            }
+            detectors.push_back(new HandDetector);
+            collectors.push_back(new SampleCollector);
+            inputters.push_back(new CommandInputter);
+            engines.push_back(new ReplayEngine(detectors.back(), collectors.back(),
+                                               service.createClient(), inputters.back()));
+            auto engine = engines.back();
+            engine->setDryRun(parser.isSet(dry_run_option));
+            engine->setFrameSource(source);
+            if (parser.isSet(output_option) && !engine->setOutput(streamFile(parser.value(output_option), i)))
+            {
+                qCritical().noquote() << "Failed to open the output file" << streamFile(parser.value(output_option), i);
+                cleanup();
+                return 1;
+            }
+            engine->applySettings();
+            if (parser.isSet(standby_option))
+                engine->setStandbyTimeout(parser.value(standby_option).toInt());
+            if (parser.isSet(learning_rate_option))
+                detectors.back()->setBackgroundLearningRate(parser.value(learning_rate_option).toDouble());
+            if (parser.isSet(verbose_option))
+                QObject::connect(inputters.back(), &CommandInputterInterface::commandMade,
+                                 [i](const QString &cmd){ qDebug().noquote() << i << cmd; });
+        }
+
+        // the service must serve before the first hand image arrives
+        service.start();
+        int running = 0;
+        // a stream counts as finished once, whether its recording ended or its source failed
+        std::vector<bool> finished_streams(engines.size(), false);
+        for (std::size_t i = 0; i < engines.size(); ++i)
+        {
+            if (!engines[i]->openCamera())
+            {
+                qCritical().noquote() << "Failed to open the frame source" << descriptions.at(static_cast<int>(i));
+                continue;
+            }
+            if (!engines[i]->startControllingTask(parser.value(model_option), parser.value(keymap_option)))
+            {
+                engines[i]->releaseCamera();
+                continue;
+            }
+            ++running;
+            // quit after every stream finished
+            const auto finished = [&running, &finished_streams, i]() {
+                if (finished_streams[i])
+                    return;
+                finished_streams[i] = true;
+                if (--running == 0)
+                    QCoreApplication::quit();
+            };
+            QObject::connect(engines[i], &ReplayEngine::replayFinished, finished);
+            QObject::connect(engines[i], &GestureEngine::cameraReleased, finished);
+            QObject::connect(&a, &QCoreApplication::aboutToQuit, engines[i], &GestureEngine::releaseCamera);
+        }
+
+        int res = 1;
+        if (running > 0)
+        {
+            quitOnSignals(a);
+            res = a.exec();
+            for (std::size_t i = 0; i < engines.size(); ++i)
+            {
+                const auto file = streamFile(parser.value(latency_option), static_cast<int>(i));
+                if (parser.isSet(latency_option) && !engines[i]->stage_profiler.writeCsv(file))
+                {
+                    qCritical().noquote() << "Failed to write the latency into" << file;
+                    res = 1;
+                }
+            }
+            const auto passes = service.forwardPasses();
+            QTextStream(stderr) << "streams: " << engines.size()
+                                << "  forward passes: " << passes
+                                << "  mean batch size: "
+                                << QString::number(passes > 0 ? static_cast<double>(service.analyzedImages())/passes : 0.0, 'f', 2)
+                                << '\n';
+        }
+        cleanup();
+        return res;
+    }
+
+    auto h = new HandDetector;
+    auto s = new SampleCollector;
+    auto g = new GestureAnalyst;
+    auto c = new CommandInputter;
+
+    FrameSourceInterface *source = nullptr;
+    if (parser.isSet(replay_option))
+        source = new ReplaySource(parser.value(replay_option),
+                                  !parser.isSet(fast_option),
+                                  parser.value(replay_fps_option).toDouble());
+    else if (parser.isSet(source_option))
+    {
+        source = FrameSourceFactory::create(parser.value(source_option),
+                                            parser.value(fps_option).toUInt(),
+                                            !parser.isSet(fast_option),
+                                            parser.value(replay_fps_option).toDouble());
+        if (source == nullptr)
+        {
+            qCritical().noquote() << "Invalid frame source" << parser.value(source_option);
+            delete h;
+            delete s;
+            delete g;
+            delete c;
+            return 1;
+        }
+    }
+
+    ReplayEngine engine(h, s, g, c);
+    engine.setCameraDevice(parser.value(camera_option).toInt());
+    engine.setCameraFps(parser.value(fps_option).toUInt());
+    engine.setDryRun(parser.isSet(dry_run_option));
+    if (source != nullptr)
+        engine.setFrameSource(source);
+    if (parser.isSet(output_option) && !engine.setOutput(parser.value(output_option)))
+    {
+        qCritical().noquote() << "Failed to open the output file" << parser.value(output_option);
+        delete h;
+        delete s;
+        delete g;
+        delete c;
+        return 1;
+    }
+
+    // the detector must be configured before the first frame arrives
+    engine.applySettings();
+    if (parser.isSet(standby_option))
+        engine.setStandbyTimeout(parser.value(standby_option).toInt());
+    if (parser.isSet(learning_rate_option))
+        h->setBackgroundLearningRate(parser.value(learning_rate_option).toDouble());
+
+    int res = 1;
+    if (engine.openCamera())
+    {
+        if (engine.startControllingTask(parser.value(model_option), parser.value(keymap_option)))
+        {
+            if (parser.isSet(verbose_option))
+                QObject::connect(c, &CommandInputterInterface::commandMade,
+                                 [](const QString &cmd){ qDebug().noquote() << cmd; });
+            QObject::connect(&engine, &GestureEngine::cameraReleased, &a, &QCoreApplication::quit);
+            QObject::connect(&a, &QCoreApplication::aboutToQuit, &engine, &GestureEngine::releaseCamera);
+            QObject::connect(&engine, &ReplayEngine::replayFinished, &a, &QCoreApplication::quit);
+            quitOnSignals(a);
+
+            res = a.exec();
+            if (parser.isSet(latency_option) && !engine.stage_profiler.writeCsv(parser.value(latency_option)))
+            {
+                qCritical().noquote() << "Failed to write the latency into" << parser.value(latency_option);
+                res = 1;
+            }
+        }
+        else
+            engine.releaseCamera();
+    }
+    else
+        qCritical().noquote() << "Failed to open the frame source";
+
+    delete h;
+    delete s;
+    delete g;
+    delete c;
+
+    return res;
+}
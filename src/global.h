@@ -12,6 +12,50 @@
  */
 #define CAMERA_FPS 50
 #endif
+#ifndef PREVIEW_FPS
+/**
+ * @brief PREVIEW_FPS is the maximum FPS at which the captured frame is rendered on the tracking window.
+ */
+#define PREVIEW_FPS 30
+#endif
+#ifndef DEFAULT_STANDBY_TIMEOUT
+/**
+ * @brief DEFAULT_STANDBY_TIMEOUT is the default time, in ms, without any hand detected after which the pipeline goes into standby. 0 disables the standby.
+ *
+ * @see #FramePipeline::setStandbyTimeout
+ */
+#define DEFAULT_STANDBY_TIMEOUT 3000
+#endif
+#ifndef STANDBY_FPS
+/**
+ * @brief STANDBY_FPS is the FPS at which frames are captured during standby.
+ */
+#define STANDBY_FPS 5
+#endif
+#ifndef STANDBY_PRESENCE_SCALE
+/**
+ * @brief STANDBY_PRESENCE_SCALE is the factor by which the region of interesting is shrunk for the presence check during standby.
+ */
+#define STANDBY_PRESENCE_SCALE 4
+#endif
+#ifndef BACKGROUND_SQUARED_DISTANCE
+/**
+ * @brief BACKGROUND_SQUARED_DISTANCE is the minimum squared distance in BGR color space from the background image for a pixel to be foreground.
+ */
+#define BACKGROUND_SQUARED_DISTANCE 240
+#endif
+#ifndef DEFAULT_BACKGROUND_LEARNING_RATE
+/**
+ * @brief DEFAULT_BACKGROUND_LEARNING_RATE is the default weight by which the background pixels of each frame are blended into the background image. 0 keeps the background image as set.
+ */
+#define DEFAULT_BACKGROUND_LEARNING_RATE 0
+#endif
+#ifndef LATENCY_REFRESH_INTERVAL
+/**
+ * @brief LATENCY_REFRESH_INTERVAL is the interval, in ms, at which the latency table on the monitor window is refreshed.
+ */
+#define LATENCY_REFRESH_INTERVAL 500
+#endif
 
 #ifndef DEFAULT_ROI_MARGIN_LEFT
 /**
@@ -105,6 +149,67 @@
  */
 #define DEFAULT_SKIN_DETECTION_AREA 5000
 #endif
+#ifndef DEFAULT_DETECTION_PYRAMID_SCALE
+/**
+ * @brief DEFAULT_DETECTION_PYRAMID_SCALE is the default factor by which the image is shrunk to locate the hand before detecting it at full resolution. 1 disables it.
+ */
+#define DEFAULT_DETECTION_PYRAMID_SCALE 2
+#endif
+#ifndef PREPROCESSING_BAND_ROWS
+/**
+ * @brief PREPROCESSING_BAND_ROWS is the minimum number of rows of a horizontal band of the image preprocessed in parallel with the others.
+ */
+#define PREPROCESSING_BAND_ROWS 96
+#endif
+#ifndef DEFAULT_DETECTION_MAX_HANDS
+/**
+ * @brief DEFAULT_DETECTION_MAX_HANDS is the default maximum number of hands detected in an image.
+ */
+#define DEFAULT_DETECTION_MAX_HANDS 1
+#endif
+#ifndef DEFAULT_DETECTION_TRACKING
+/**
+ * @brief DEFAULT_DETECTION_TRACKING is the default flag, boolean value, if the hand is searched around its last position while controlling.
+ */
+#define DEFAULT_DETECTION_TRACKING true
+#endif
+#ifndef DETECTION_TRACKING_MARGIN
+/**
+ * @brief DETECTION_TRACKING_MARGIN is the margin, in percent of the larger side of the hand, by which the search window exceeds the predicted hand on each side.
+ */
+#define DETECTION_TRACKING_MARGIN 25
+#endif
+#ifndef DETECTION_TRACKING_REFRESH
+/**
+ * @brief DETECTION_TRACKING_REFRESH is the number of frames after which the whole image is searched even if the hand is tracked.
+ */
+#define DETECTION_TRACKING_REFRESH 30
+#endif
+#ifndef FINGER_TRACKING_GATE
+/**
+ * @brief FINGER_TRACKING_GATE is the maximum distance, in pixels, between a finger top and the expected position of a tracked finger it is assigned to.
+ */
+#define FINGER_TRACKING_GATE 40
+#endif
+#ifndef FINGER_TRACKING_MISSES
+/**
+ * @brief FINGER_TRACKING_MISSES is the number of frames a tracked finger is kept without any finger top assigned to it.
+ */
+#define FINGER_TRACKING_MISSES 3
+#endif
+#ifndef FINGER_TRACKING_HULL_TOLERANCE
+/**
+ * @brief FINGER_TRACKING_HULL_TOLERANCE is the change, in pixels of the sides of its bounding box, under which the convex hull of the hand is taken as unchanged while tracking,
+ *        such that the finger tops are predicted instead of estimated again.
+ */
+#define FINGER_TRACKING_HULL_TOLERANCE 4
+#endif
+#ifndef FINGER_TRACKING_REFRESH
+/**
+ * @brief FINGER_TRACKING_REFRESH is the maximum number of successive frames on which the finger tops are predicted instead of estimated.
+ */
+#define FINGER_TRACKING_REFRESH 5
+#endif
 #ifndef DEFAULT_SKIN_MORPHOLOGY
 /**
  * @brief DEFAULT_SKIN_MORPHOLOGY is the default flag, boolean value, if the morphological transformation is performed or not.
@@ -22,21 +22,44 @@
     "          God of coders blesses us. No bug will be met.          "
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
 
 #include "GestureControlSystem.h"
 #include "CommandInputter.h"
 #include "GestureAnalyst.h"
+#include "FrameSourceFactory.h"
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption source_option(QStringList() << "s" << "source",
+                                     "Read frames from the source instead of the camera: " + FrameSourceFactory::usage() + ".", "source");
+    parser.addOption(source_option);
+    parser.process(a);
+
+    FrameSourceInterface *source = nullptr;
+    if (parser.isSet(source_option))
+    {
+        source = FrameSourceFactory::create(parser.value(source_option));
+        if (source == nullptr)
+        {
+            qCritical().noquote() << "Invalid frame source" << parser.value(source_option);
+            return 1;
+        }
+    }
+
     auto h = new HandDetector;
     auto s = new SampleCollector;
     auto g = new GestureAnalyst;
     auto c = new CommandInputter;
 
     GestureControlSystem gcs(h, s, g, c);
+    if (source != nullptr)
+        gcs.setFrameSource(source);
     gcs.run();
 
     auto res = a.exec();